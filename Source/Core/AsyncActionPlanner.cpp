@@ -0,0 +1,93 @@
+#include "AsyncActionPlanner.h"
+
+namespace Urho3D
+{
+
+AsyncActionPlanner::AsyncActionPlanner(int size, Callback onPlanned)
+    : onPlanned_(ea::move(onPlanned))
+    , pendingSettings_(size)
+    , sim_(size)
+{
+#ifndef SNAKE4D_NO_THREADS
+    thread_ = std::thread([this] { PlannerLoop(); });
+#endif
+}
+
+AsyncActionPlanner::~AsyncActionPlanner()
+{
+#ifndef SNAKE4D_NO_THREADS
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    wakeCondition_.notify_one();
+    thread_.join();
+#endif
+}
+
+void AsyncActionPlanner::Start(const GameSimulation& sim)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    pendingSettings_.CopySettings(sim);
+    sim.SaveState(pendingState_);
+    pendingHash_ = sim.GetHash();
+    hasPendingState_ = true;
+
+#ifdef SNAKE4D_NO_THREADS
+    // There is no planner thread, plan right away
+    PlanPendingState(lock);
+#else
+    lock.unlock();
+    wakeCondition_.notify_one();
+#endif
+}
+
+bool AsyncActionPlanner::TryGetAction(unsigned long long hash, UserAction& action)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!hasPlannedAction_ || plannedHash_ != hash)
+        return false;
+
+    action = plannedAction_;
+    return true;
+}
+
+void AsyncActionPlanner::PlannerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        wakeCondition_.wait(lock, [this] { return shutdown_ || hasPendingState_; });
+        if (shutdown_)
+            return;
+
+        PlanPendingState(lock);
+    }
+}
+
+void AsyncActionPlanner::PlanPendingState(std::unique_lock<std::mutex>& lock)
+{
+    // Take pending state, so Start may capture the next one while this one is planned
+    sim_.CopySettings(pendingSettings_);
+    ea::swap(state_, pendingState_);
+    const unsigned long long hash = pendingHash_;
+    hasPendingState_ = false;
+    lock.unlock();
+
+    sim_.RestoreState(state_);
+    const UserAction action = sim_.EstimateBestAction();
+
+    lock.lock();
+    plannedHash_ = hash;
+    plannedAction_ = action;
+    hasPlannedAction_ = true;
+
+    if (onPlanned_)
+    {
+        lock.unlock();
+        onPlanned_();
+        lock.lock();
+    }
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "GameSimulation.h"
+
+#include <EASTL/functional.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Urho3D
+{
+
+/// Estimates best action of the simulation on dedicated thread, so planning overlaps with waiting for the next tick.
+/// Planner works on its own copy of the simulation restored from the state captured by Start.
+/// Builds without threads (SNAKE4D_NO_THREADS) plan synchronously in Start.
+class AsyncActionPlanner
+{
+public:
+    using Callback = ea::function<void()>;
+
+    /// Callback is called on planner thread each time an action is planned, or inside Start if there are no threads.
+    AsyncActionPlanner(int size, Callback onPlanned = {});
+    ~AsyncActionPlanner();
+
+    AsyncActionPlanner(const AsyncActionPlanner&) = delete;
+    AsyncActionPlanner& operator=(const AsyncActionPlanner&) = delete;
+
+    /// Start planning for current state of the simulation. Older state is dropped if its planning is not started yet.
+    void Start(const GameSimulation& sim);
+
+    /// Return action planned for the state with given hash if it is ready. Never waits.
+    bool TryGetAction(unsigned long long hash, UserAction& action);
+
+private:
+    void PlannerLoop();
+    /// Plan action for pending state. Lock is released while planning.
+    void PlanPendingState(std::unique_lock<std::mutex>& lock);
+
+#ifndef SNAKE4D_NO_THREADS
+    std::thread thread_;
+#endif
+    std::mutex mutex_;
+    std::condition_variable wakeCondition_;
+    bool shutdown_{};
+    Callback onPlanned_;
+
+    /// State captured by Start and not taken by planner thread yet.
+    GameSimulation pendingSettings_;
+    SimulationState pendingState_;
+    unsigned long long pendingHash_{};
+    bool hasPendingState_{};
+
+    /// The last planned action.
+    unsigned long long plannedHash_{};
+    UserAction plannedAction_{};
+    bool hasPlannedAction_{};
+
+    /// Owned by planner thread.
+    GameSimulation sim_;
+    SimulationState state_;
+};
+
+}
@@ -0,0 +1,166 @@
+#include "GameReplay.h"
+
+#include <cstdio>
+
+namespace Urho3D
+{
+
+namespace
+{
+
+const unsigned ReplayMagic = 0x34504C52; // "RLP4"
+const unsigned ReplayVersion = 2;
+
+enum ReplayFlag : unsigned
+{
+    ReplayFlagWrapAround = 1 << 0
+};
+
+}
+
+bool ReplayWriter::Open(const ea::string& fileName, const GameSimulation& sim)
+{
+    Close();
+
+    FILE* file = fopen(fileName.c_str(), "wb");
+    if (!file)
+        return false;
+
+    const ea::vector<IntVector4>& targets = sim.GetPredefinedTargets();
+
+    header_ = {};
+    header_.magic_ = ReplayMagic;
+    header_.version_ = ReplayVersion;
+    header_.gridSize_ = sim.GetSize();
+    header_.lengthIncrement_ = sim.GetLengthIncrement();
+    header_.numTargets_ = sim.GetNumTargets();
+    header_.flags_ = sim.GetTopology().IsWrapAround() ? ReplayFlagWrapAround : 0;
+    header_.numPredefinedTargets_ = targets.size();
+    header_.seed_ = sim.GetSeed();
+    header_.levelHash_ = sim.GetLevel().hash_;
+
+    file_ = file;
+    numTicks_ = 0;
+    numWrittenBytes_ = 0;
+    bitBuffer_ = 0;
+    numBufferedBits_ = 0;
+    pendingBytes_.clear();
+
+    WriteHeader(0);
+    if (fwrite(targets.data(), sizeof(IntVector4), targets.size(), file) != targets.size())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void ReplayWriter::RecordTick(UserAction action, const GameSimulation& sim)
+{
+    if (!file_)
+        return;
+
+    const unsigned tickBits = static_cast<unsigned>(action) | (sim.GetChecksum() << ReplayBitsPerAction);
+    bitBuffer_ |= tickBits << numBufferedBits_;
+    numBufferedBits_ += ReplayBitsPerTick;
+    ++numTicks_;
+
+    while (numBufferedBits_ >= 8)
+    {
+        pendingBytes_.push_back(static_cast<unsigned char>(bitBuffer_));
+        bitBuffer_ >>= 8;
+        numBufferedBits_ -= 8;
+    }
+
+    if (pendingBytes_.size() >= FlushSize)
+        Flush();
+}
+
+void ReplayWriter::Flush()
+{
+    if (!file_)
+        return;
+
+    auto file = static_cast<FILE*>(file_);
+    fwrite(pendingBytes_.data(), 1, pendingBytes_.size(), file);
+    numWrittenBytes_ += pendingBytes_.size();
+    pendingBytes_.clear();
+
+    // Only ticks that fit into written bytes are complete
+    WriteHeader(numWrittenBytes_ * 8 / ReplayBitsPerTick);
+    fflush(file);
+}
+
+void ReplayWriter::Close()
+{
+    if (!file_)
+        return;
+
+    // Pad the last byte
+    if (numBufferedBits_ > 0)
+        pendingBytes_.push_back(static_cast<unsigned char>(bitBuffer_));
+    bitBuffer_ = 0;
+    numBufferedBits_ = 0;
+
+    Flush();
+    WriteHeader(numTicks_);
+
+    fclose(static_cast<FILE*>(file_));
+    file_ = nullptr;
+}
+
+void ReplayWriter::WriteHeader(unsigned long long numTicks)
+{
+    auto file = static_cast<FILE*>(file_);
+    header_.numTicks_ = numTicks;
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header_, sizeof(header_), 1, file);
+    fseek(file, 0, SEEK_END);
+}
+
+bool GameReplay::Load(const ea::string& fileName)
+{
+    header_ = {};
+    targets_.clear();
+    ticks_.clear();
+
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (!file)
+        return false;
+
+    ReplayHeader header{};
+    bool loaded = fread(&header, sizeof(header), 1, file) == 1 && header.magic_ == ReplayMagic
+        && header.version_ == ReplayVersion && header.gridSize_ > 0;
+    if (loaded)
+    {
+        targets_.resize(header.numPredefinedTargets_);
+        ticks_.resize(static_cast<unsigned>((header.numTicks_ * ReplayBitsPerTick + 7) / 8));
+        loaded = fread(targets_.data(), sizeof(IntVector4), targets_.size(), file) == targets_.size()
+            && fread(ticks_.data(), 1, ticks_.size(), file) == ticks_.size();
+    }
+    fclose(file);
+
+    if (!loaded)
+    {
+        targets_.clear();
+        ticks_.clear();
+        return false;
+    }
+
+    header_ = header;
+    return true;
+}
+
+bool GameReplay::StartPlayback(GameSimulation& sim) const
+{
+    if (!IsLoaded() || sim.GetSize() != header_.gridSize_ || sim.GetLevel().hash_ != header_.levelHash_)
+        return false;
+
+    sim.SetLengthIncrement(header_.lengthIncrement_);
+    sim.SetNumTargets(header_.numTargets_);
+    sim.SetWrapAround((header_.flags_ & ReplayFlagWrapAround) != 0);
+    sim.Reset(targets_, header_.seed_);
+    return true;
+}
+
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "GameSimulation.h"
+
+#include <EASTL/string.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Header of replay file. It is followed by predefined targets and packed ticks.
+/// Each tick takes 19 bits: 3 bits of user action and 16 bits of state checksum after the tick.
+struct ReplayHeader
+{
+    unsigned magic_;
+    unsigned version_;
+    int gridSize_;
+    unsigned lengthIncrement_;
+    unsigned numTargets_;
+    unsigned flags_;
+    unsigned numPredefinedTargets_;
+    unsigned reserved_;
+    unsigned long long seed_;
+    /// Hash of the level, zero if the game is not played on a level.
+    unsigned long long levelHash_;
+    unsigned long long numTicks_;
+};
+
+static const unsigned ReplayBitsPerAction = 3;
+static const unsigned ReplayBitsPerChecksum = 16;
+static const unsigned ReplayBitsPerTick = ReplayBitsPerAction + ReplayBitsPerChecksum;
+
+static_assert(static_cast<unsigned>(UserAction::Count) <= (1u << ReplayBitsPerAction), "User action must fit into 3 bits");
+
+/// Records replay of the game and streams it to file.
+/// Replay consists of seed, settings that affect ticks, user action and state checksum of each tick.
+class ReplayWriter
+{
+public:
+    ReplayWriter() = default;
+    ~ReplayWriter() { Close(); }
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    /// Create replay file for the game. Should be called right after the simulation is reset.
+    bool Open(const ea::string& fileName, const GameSimulation& sim);
+    /// Record tick that has just been simulated with given action.
+    void RecordTick(UserAction action, const GameSimulation& sim);
+    /// Write recorded ticks to file, the file is valid replay afterwards.
+    void Flush();
+    /// Write remaining ticks and close the file.
+    void Close();
+
+    bool IsOpen() const { return file_ != nullptr; }
+
+    unsigned long long GetNumTicks() const { return numTicks_; }
+
+private:
+    /// Recorded bytes are written to file in blocks of this size.
+    static const unsigned FlushSize = 4096;
+
+    void WriteHeader(unsigned long long numTicks);
+
+    void* file_{};
+    ReplayHeader header_{};
+    unsigned long long numTicks_{};
+    unsigned long long numWrittenBytes_{};
+
+    /// Bits of ticks that do not fill a byte yet.
+    unsigned bitBuffer_{};
+    unsigned numBufferedBits_{};
+    ea::vector<unsigned char> pendingBytes_;
+};
+
+/// Replay loaded into memory. Actions are decoded on access, so any tick is reached without unpacking.
+class GameReplay
+{
+public:
+    /// Load replay file.
+    bool Load(const ea::string& fileName);
+
+    bool IsLoaded() const { return header_.magic_ != 0; }
+
+    const ReplayHeader& GetHeader() const { return header_; }
+
+    unsigned long long GetNumTicks() const { return header_.numTicks_; }
+
+    /// Return user action of the tick.
+    UserAction GetAction(unsigned long long tick) const
+    {
+        return static_cast<UserAction>(GetTickBits(tick) & ActionMask);
+    }
+
+    /// Return checksum of the state after the tick.
+    unsigned short GetChecksum(unsigned long long tick) const
+    {
+        return static_cast<unsigned short>(GetTickBits(tick) >> ReplayBitsPerAction);
+    }
+
+    /// Apply replay settings to the simulation and reset it to the beginning of the game.
+    /// Level should be set beforehand. Return false if simulation cannot reproduce the replay.
+    bool StartPlayback(GameSimulation& sim) const;
+
+    /// Play ticks in range [beginTick, endTick) as fast as possible.
+    void Play(GameSimulation& sim, unsigned long long beginTick, unsigned long long endTick) const
+    {
+        endTick = ea::min(endTick, header_.numTicks_);
+        for (unsigned long long tick = beginTick; tick < endTick; ++tick)
+        {
+            sim.SetNextAction(GetAction(tick));
+            sim.Tick();
+        }
+    }
+
+    /// Play ticks in range [beginTick, endTick) and compare state checksums with recorded ones.
+    /// Return the first divergent tick, playback stops after it. Return endTick if all ticks match.
+    unsigned long long PlayAndVerify(GameSimulation& sim, unsigned long long beginTick, unsigned long long endTick) const
+    {
+        endTick = ea::min(endTick, header_.numTicks_);
+        for (unsigned long long tick = beginTick; tick < endTick; ++tick)
+        {
+            const unsigned tickBits = GetTickBits(tick);
+            sim.SetNextAction(static_cast<UserAction>(tickBits & ActionMask));
+            sim.Tick();
+            if (sim.GetChecksum() != tickBits >> ReplayBitsPerAction)
+                return tick;
+        }
+        return endTick;
+    }
+
+private:
+    static const unsigned ActionMask = (1u << ReplayBitsPerAction) - 1;
+    static const unsigned TickMask = (1u << ReplayBitsPerTick) - 1;
+
+    /// Return packed bits of the tick.
+    unsigned GetTickBits(unsigned long long tick) const
+    {
+        assert(tick < header_.numTicks_);
+        const unsigned long long bitIndex = tick * ReplayBitsPerTick;
+        const auto byteIndex = static_cast<unsigned>(bitIndex / 8);
+        // Tick spans up to four bytes, the last byte is padded
+        unsigned long long value = 0;
+        for (unsigned i = 0; i < 4 && byteIndex + i < ticks_.size(); ++i)
+            value |= static_cast<unsigned long long>(ticks_[byteIndex + i]) << (8 * i);
+        return static_cast<unsigned>(value >> (bitIndex % 8)) & TickMask;
+    }
+
+    ReplayHeader header_{};
+    ea::vector<IntVector4> targets_;
+    ea::vector<unsigned char> ticks_;
+};
+
+}
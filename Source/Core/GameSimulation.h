@@ -0,0 +1,1251 @@
+#pragma once
+
+#include "Math4D.h"
+#include "GridCamera4D.h"
+#include "GridFreeCellSet4D.h"
+#include "GridFreeSpace4D.h"
+#include "GridHamiltonianCycle4D.h"
+#include "GridObstacleSet4D.h"
+#include "GridPathFinder4D.h"
+#include "GridPointIndex4D.h"
+#include "GridRotation4D.h"
+#include "GridTopology4D.h"
+#include "LevelPack.h"
+#include "RandomGenerator.h"
+#include "ZobristHash.h"
+
+#include <EASTL/shared_ptr.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+enum class UserAction
+{
+    None,
+    Left,
+    Right,
+    Up,
+    Down,
+    Red,
+    Blue,
+    XRoll,
+
+    Count
+};
+
+using ActionCache = TranspositionCache<UserAction>;
+
+/// Algorithm used to estimate best action.
+enum class AutopilotMode
+{
+    /// Shortest path to the target, may trap the snake.
+    PathFinder,
+    /// Follow precomputed Hamiltonian cycle with safe shortcuts, never traps the snake.
+    HamiltonianCycle
+};
+
+enum class CurrentAnimationType
+{
+    Idle,
+    Rotation,
+    ColorRotation
+};
+
+struct AnimationSettings
+{
+    float cameraTranslationSpeed_{ 1.0f };
+    float cameraRotationSpeed_{ 3.0f };
+    float snakeMovementSpeed_{ 6.0f };
+};
+
+/// Return camera rotation performed by user action.
+inline const RotationDelta4D& GetActionRotation(UserAction action)
+{
+    static constexpr RotationDelta4D rotations[static_cast<unsigned>(UserAction::Count)] = {
+        RotationDelta4D::Make(0, 1,   0.0f), // None
+        RotationDelta4D::Make(0, 2, -90.0f), // Left
+        RotationDelta4D::Make(0, 2,  90.0f), // Right
+        RotationDelta4D::Make(1, 2,  90.0f), // Up
+        RotationDelta4D::Make(1, 2, -90.0f), // Down
+        RotationDelta4D::Make(2, 3,  90.0f), // Red
+        RotationDelta4D::Make(2, 3, -90.0f), // Blue
+        RotationDelta4D::Make(0, 3,  90.0f), // XRoll
+    };
+    return rotations[static_cast<unsigned>(action)];
+}
+
+inline GridRotationIndex RotateCubeFrame(GridRotationIndex frame, GridDirection4D from, GridDirection4D to)
+{
+    return ComposeRotations(MakeDeltaRotation(from, to), frame);
+}
+
+/// Snake element with cube frame stored as rotation index and direction, 20 bytes instead of 160 bytes of frame vertices.
+/// Position is kept as full vector, because coordinates of sparse boards don't fit into narrower types.
+struct SnakeElement
+{
+    IntVector4 position_;
+    /// Rotation of initial cube frame.
+    GridRotationIndex beginFrameRotation_{};
+    /// Direction from element center to cube frame center.
+    GridDirection4D beginFrameOffset_{};
+};
+
+static_assert(sizeof(SnakeElement) <= 20, "Snake element should stay compact");
+
+/// Snake elements ordered from head to tail, stored in ring buffer.
+/// Previous state of the snake is a view of the same storage, so ticks never copy the body.
+class SnakeBody
+{
+public:
+    void Clear()
+    {
+        head_ = 0;
+        length_ = 0;
+        previousHead_ = 0;
+        previousLength_ = 0;
+        ++layoutVersion_;
+    }
+
+    void PushFront(const SnakeElement& element)
+    {
+        Reserve(GetUsedSpan() + 1);
+        --head_;
+        ++length_;
+        elements_[head_ & mask_] = element;
+    }
+
+    void PushBack(const SnakeElement& element)
+    {
+        Reserve(GetUsedSpan() + 1);
+        elements_[(head_ + length_) & mask_] = element;
+        ++length_;
+        ++layoutVersion_;
+    }
+
+    void PopBack()
+    {
+        assert(length_ > 0);
+        --length_;
+    }
+
+    /// Remove head element. Previous state is collapsed into current one.
+    void PopFront()
+    {
+        assert(length_ > 0);
+        ++head_;
+        --length_;
+        ++layoutVersion_;
+        CommitState();
+    }
+
+    /// Remember current state as previous state.
+    void CommitState()
+    {
+        previousHead_ = head_;
+        previousLength_ = length_;
+    }
+
+    unsigned Size() const { return length_; }
+
+    const SnakeElement& operator[](unsigned index) const { return elements_[(head_ + index) & mask_]; }
+
+    const SnakeElement& Front() const { return (*this)[0]; }
+
+    const SnakeElement& Back() const { return (*this)[length_ - 1]; }
+
+    unsigned GetPreviousSize() const { return previousLength_; }
+
+    const SnakeElement& GetPrevious(unsigned index) const { return elements_[(previousHead_ + index) & mask_]; }
+
+    /// Copy another snake body, both current and previous state.
+    /// If this body is the last copy of the same body, only elements pushed to the front since then are copied,
+    /// so copying after each tick is O(1) while the snake only moves and grows.
+    void CopyFrom(const SnakeBody& other)
+    {
+        const unsigned numNewElements = head_ - other.head_;
+        const bool incremental = layoutVersion_ == other.layoutVersion_ && mask_ == other.mask_
+            && elements_.size() == other.elements_.size() && numNewElements <= elements_.size();
+        if (incremental)
+        {
+            // Other elements are not written unless layout is changed
+            for (unsigned index = other.head_; index != head_; ++index)
+                elements_[index & mask_] = other.elements_[index & mask_];
+        }
+        else
+        {
+            elements_ = other.elements_;
+            mask_ = other.mask_;
+            layoutVersion_ = other.layoutVersion_;
+        }
+
+        head_ = other.head_;
+        length_ = other.length_;
+        previousHead_ = other.previousHead_;
+        previousLength_ = other.previousLength_;
+    }
+
+private:
+    /// Return number of slots used by both current and previous state.
+    unsigned GetUsedSpan() const
+    {
+        // Head only moves backward between commits
+        return ea::max(length_, previousHead_ - head_ + previousLength_);
+    }
+
+    void Reserve(unsigned capacity)
+    {
+        if (capacity <= elements_.size())
+            return;
+
+        unsigned newCapacity = ea::max(16u, static_cast<unsigned>(elements_.size()));
+        while (newCapacity < capacity)
+            newCapacity *= 2;
+
+        const unsigned usedSpan = GetUsedSpan();
+        ea::vector<SnakeElement> newElements(newCapacity);
+        for (unsigned i = 0; i < usedSpan; ++i)
+            newElements[i] = elements_[(head_ + i) & mask_];
+
+        previousHead_ -= head_;
+        head_ = 0;
+        elements_ = ea::move(newElements);
+        mask_ = newCapacity - 1;
+        ++layoutVersion_;
+    }
+
+    ea::vector<SnakeElement> elements_;
+    unsigned mask_{};
+    /// Incremented whenever elements are written anywhere except in front of the head.
+    unsigned layoutVersion_{};
+
+    unsigned head_{};
+    unsigned length_{};
+    unsigned previousHead_{};
+    unsigned previousLength_{};
+};
+
+/// Return whether snake head may enter the cell: the cell is on the board and is not an obstacle or snake body.
+inline bool IsValidHeadPosition(const GridTopology4D& topology, const GridObstacleSet4D& obstacles,
+    const SnakeBody& snake, const IntVector4& position)
+{
+    if (topology.IsOutside(position) || obstacles.Contains(position))
+        return false;
+
+    for (unsigned i = 1; i < snake.Size(); ++i)
+    {
+        if (position == snake[i].position_)
+            return false;
+    }
+    return true;
+}
+
+/// Return animation of the camera at given blend factor of the tick.
+inline CurrentAnimationType GetCurrentAnimationType(const GridCamera4D& camera, const AnimationSettings& settings, float blendFactor)
+{
+    if (blendFactor * settings.cameraRotationSpeed_ >= 1.0f)
+        return CurrentAnimationType::Idle;
+    else if (camera.IsColorRotating())
+        return CurrentAnimationType::ColorRotation;
+    else if (camera.IsRotating())
+        return CurrentAnimationType::Rotation;
+    else
+        return CurrentAnimationType::Idle;
+}
+
+/// Compact copy of simulation state that affects future ticks.
+/// Path finder scratch, free cell set and camera animation are not stored.
+/// Snake is stored as head position and per-element offsets, positions and cube frames are derived on restore.
+/// State is not POD: snake offsets and targets are vectors, because snake length is bounded only by the board.
+/// Copying into a new state allocates twice, copying into a reused state allocates only when it has to grow.
+struct SimulationState
+{
+    IntVector4 snakeHead_{};
+    GridRotationIndex cameraRotation_{};
+    GridRotationIndex tailFrameRotation_{};
+    /// Direction from each snake element to the previous one, from head to tail.
+    ea::vector<GridDirection4D> snakeOffsets_;
+
+    ea::vector<IntVector4> targetPositions_;
+    unsigned currentTarget_{};
+    unsigned nextTargetIndex_{};
+    unsigned pendingGrowth_{};
+    UserAction nextAction_{};
+    UserAction bestAction_{};
+    bool gameOver_{};
+    bool deathAnimation_{};
+    unsigned long long seed_{};
+    RandomGenerator random_;
+};
+
+/// Changes made by single tick, enough to undo it without snapshot of the snake.
+struct TickDelta
+{
+    /// Tail element removed on the tick.
+    SnakeElement tail_;
+    /// Position of the target eaten on the tick.
+    IntVector4 eatenTarget_{};
+    unsigned eatenTargetIndex_{};
+
+    unsigned long long hash_{};
+    RandomGenerator random_;
+    unsigned pendingGrowth_{};
+    unsigned nextTargetIndex_{};
+    unsigned currentTarget_{};
+    GridRotationIndex cameraRotation_{};
+    UserAction nextAction_{};
+    UserAction bestAction_{};
+    unsigned char flags_{};
+};
+
+class GameSimulation
+{
+    /// Number of free cells kept between snake head and tail when taking shortcuts.
+    static const unsigned ShortcutTailReserve = 4;
+
+public:
+    GameSimulation() = default;
+
+    explicit GameSimulation(int size)
+        : size_(size)
+        , topology_(size)
+        , startPosition_(GetDefaultStartPosition(size))
+        , targetIndex_(size)
+        , pathFinder_(size)
+        , freeCells_(size)
+        , freeSpace_(IsDenseGrid(size) ? size : 0)
+    {
+        Reset({});
+    }
+
+    /// Set obstacles and start pose of the level and reset game state. Level data is used in place.
+    void StartLevel(const GameLevel& level, unsigned long long seed = 0)
+    {
+        SetLevel(level);
+        Reset(level.targets_, seed);
+    }
+
+    /// Reset game state. The seed fully determines target spawning.
+    void Reset(ea::span<const IntVector4> targets, unsigned long long seed = 0)
+    {
+        seed_ = seed;
+        random_.SetSeed(seed_);
+
+        nextAction_ = UserAction::None;
+        gameOver_ = false;
+        deathAnimation_ = false;
+        pendingGrowth_ = 0;
+
+        // Snake is laid behind the head
+        const GridDirection4D startHeading = RotateDirection(startRotation_, MakeGridDirection(2, 1));
+        const IntVector4& startDirection = DirectionToIntVector(startHeading);
+        snake_.Clear();
+        for (int i = 0; i < 3; ++i)
+        {
+            SnakeElement element;
+            element.position_ = topology_.Wrap(startPosition_ - i * startDirection);
+            element.beginFrameRotation_ = startRotation_;
+            element.beginFrameOffset_ = ReverseDirection(startHeading);
+            snake_.PushBack(element);
+        }
+        snake_.CommitState();
+
+        ResetFreeCells();
+
+        camera_.Reset(GetSnakeHead(), startDirection, startRotation_);
+        IntVector4 targetPosition{ size_ / 2, size_ / 2, size_ * 3 / 4, size_ / 2 };
+
+        targets_.assign(targets.begin(), targets.end());
+        nextTargetIndex_ = 0;
+        targetPositions_.clear();
+        targetIndex_.Clear();
+        if (!targets_.empty())
+            targetPosition = targets_[nextTargetIndex_++];
+        else if (obstacles_.Contains(targetPosition))
+            targetPosition = GetAvailablePosition().first;
+
+        AddTarget(targetPosition);
+        while (targetPositions_.size() < numTargets_)
+        {
+            const auto newTarget = GetNextTargetPosition();
+            if (!newTarget.second)
+                break;
+            AddTarget(newTarget.first);
+        }
+        currentTarget_ = 0;
+
+        hash_ = ComputeHash();
+        numTickDeltas_ = 0;
+
+        // Update path
+        pathFinder_.ClearPath();
+        bestAction_ = EstimateBestAction();
+    }
+
+    /// Store state that affects future ticks.
+    void SaveState(SimulationState& state) const
+    {
+        state.snakeHead_ = GetSnakeHead();
+        state.cameraRotation_ = camera_.GetCurrentRotation();
+        state.tailFrameRotation_ = snake_.Back().beginFrameRotation_;
+        state.snakeOffsets_.resize(snake_.Size());
+        for (unsigned i = 0; i < snake_.Size(); ++i)
+            state.snakeOffsets_[i] = snake_[i].beginFrameOffset_;
+
+        state.targetPositions_.assign(targetPositions_.begin(), targetPositions_.end());
+        state.currentTarget_ = currentTarget_;
+        state.nextTargetIndex_ = nextTargetIndex_;
+        state.pendingGrowth_ = pendingGrowth_;
+        state.nextAction_ = nextAction_;
+        state.bestAction_ = bestAction_;
+        state.gameOver_ = gameOver_;
+        state.deathAnimation_ = deathAnimation_;
+        state.seed_ = seed_;
+        state.random_ = random_;
+    }
+
+    /// Restore state stored by SaveState of simulation with the same size and targets.
+    /// Previous snake state is collapsed into current one.
+    /// Cost is proportional to the lengths of current and restored snakes, not to the size of the board.
+    void RestoreState(const SimulationState& state)
+    {
+        assert(!state.snakeOffsets_.empty());
+
+        // Sampling of free cells doesn't depend on their history, so only cells of both snakes are updated.
+        // Dead head may be inside obstacle.
+        for (unsigned i = 0; i < snake_.Size(); ++i)
+        {
+            if (!IsOutside(snake_[i].position_) && !obstacles_.Contains(snake_[i].position_))
+                freeCells_.Insert(snake_[i].position_);
+        }
+
+        // Walk from tail to head, cube frames depend on the older element
+        const unsigned length = state.snakeOffsets_.size();
+        IntVector4 tailPosition = state.snakeHead_;
+        for (unsigned i = 0; i + 1 < length; ++i)
+            tailPosition = topology_.Step(tailPosition, DirectionToIntVector(state.snakeOffsets_[i]));
+
+        SnakeElement element;
+        element.position_ = tailPosition;
+        element.beginFrameRotation_ = state.tailFrameRotation_;
+        element.beginFrameOffset_ = state.snakeOffsets_[length - 1];
+
+        snake_.Clear();
+        snake_.PushFront(element);
+        for (unsigned i = length - 1; i > 0; --i)
+        {
+            const GridDirection4D prevDirection = ReverseDirection(element.beginFrameOffset_);
+            const GridDirection4D newDirection = ReverseDirection(state.snakeOffsets_[i - 1]);
+            element.position_ = topology_.Step(element.position_, DirectionToIntVector(newDirection));
+            element.beginFrameRotation_ = RotateCubeFrame(element.beginFrameRotation_, prevDirection, newDirection);
+            element.beginFrameOffset_ = state.snakeOffsets_[i - 1];
+            snake_.PushFront(element);
+        }
+        snake_.CommitState();
+
+        for (unsigned i = 0; i < snake_.Size(); ++i)
+        {
+            if (!IsOutside(snake_[i].position_))
+                freeCells_.Remove(snake_[i].position_);
+        }
+        freeSpace_.Invalidate();
+
+        camera_.Restore(state.snakeHead_, state.cameraRotation_);
+        targetPositions_.clear();
+        targetIndex_.Clear();
+        for (const IntVector4& targetPosition : state.targetPositions_)
+            AddTarget(targetPosition);
+        currentTarget_ = state.currentTarget_;
+        nextTargetIndex_ = state.nextTargetIndex_;
+        pendingGrowth_ = state.pendingGrowth_;
+        nextAction_ = state.nextAction_;
+        bestAction_ = state.bestAction_;
+        gameOver_ = state.gameOver_;
+        deathAnimation_ = state.deathAnimation_;
+        seed_ = state.seed_;
+        random_ = state.random_;
+        hash_ = ComputeHash();
+        numTickDeltas_ = 0;
+
+        // Cached path may go through cells occupied in restored state
+        pathFinder_.ClearPath();
+    }
+
+    void SetLengthIncrement(unsigned lengthIncrement) { lengthIncrement_ = lengthIncrement; }
+
+    void SetEnableRolls(bool enableRolls) { enableRolls_ = enableRolls; }
+
+    /// Set whether coordinates wrap around board edges, so there are no walls. Call before reset.
+    void SetWrapAround(bool wrapAround)
+    {
+        topology_.Reset(size_, wrapAround);
+        pathFinder_.SetTopology(topology_);
+        freeSpace_.SetWrapAround(wrapAround);
+    }
+
+    /// Set obstacles and start pose of the level, applied on next reset. Empty level clears obstacles.
+    /// Obstacles are used in place, so level data must outlive the simulation.
+    void SetLevel(const GameLevel& level)
+    {
+        assert(level.size_ == 0 || level.size_ == size_);
+        const bool obstaclesChanged = level.obstacles_.GetWords().data() != obstacles_.GetWords().data();
+
+        obstacles_ = level.obstacles_;
+        startPosition_ = level.size_ != 0 ? level.startPosition_ : GetDefaultStartPosition(size_);
+        startRotation_ = level.size_ != 0 ? level.startRotation_ : IdentityGridRotation;
+        levelHash_ = level.hash_;
+
+        // Keep free cells consistent with current snake, it may be restored from snapshot before reset
+        if (obstaclesChanged)
+        {
+            obstacleFreeCells_ = nullptr;
+            ResetFreeCells();
+        }
+    }
+
+    /// Set max number of ticks that can be rewound. Zero disables recording of tick deltas.
+    void SetRewindCapacity(unsigned capacity)
+    {
+        tickDeltas_.clear();
+        tickDeltas_.resize(capacity);
+        firstTickDelta_ = 0;
+        numTickDeltas_ = 0;
+    }
+
+    /// Return number of ticks that can be rewound now.
+    unsigned GetNumRewindableTicks() const { return numTickDeltas_; }
+
+    /// Undo last ticks, up to the number of recorded ones. Return number of undone ticks.
+    /// Each tick is undone in constant time. Animation is not rewound.
+    unsigned Rewind(unsigned numTicks)
+    {
+        numTicks = ea::min(numTicks, numTickDeltas_);
+        if (numTicks == 0)
+            return 0;
+
+        for (unsigned i = 0; i < numTicks; ++i)
+        {
+            --numTickDeltas_;
+            UndoTick(tickDeltas_[(firstTickDelta_ + numTickDeltas_) % tickDeltas_.size()]);
+        }
+
+        snake_.CommitState();
+        freeSpace_.Invalidate();
+        pathFinder_.ClearPath();
+        return numTicks;
+    }
+
+    /// Set number of targets present on the board at once, applied on next reset.
+    void SetNumTargets(unsigned numTargets) { numTargets_ = ea::max(1u, numTargets); }
+
+    /// Whether to run path finder for best action on every tick. Disable for simulations driven by external AI.
+    void SetUpdateBestAction(bool updateBestAction) { updateBestAction_ = updateBestAction; }
+
+    /// Whether path finder actions that lead into free space smaller than the snake are replaced. Ignored on large boards.
+    void SetAvoidTraps(bool avoidTraps) { avoidTraps_ = avoidTraps; }
+
+    /// Set algorithm of best action estimation. Hamiltonian cycle is generated on first use.
+    void SetAutopilotMode(AutopilotMode mode)
+    {
+        autopilotMode_ = mode;
+        if (autopilotMode_ == AutopilotMode::HamiltonianCycle && !cycle_)
+            cycle_ = ea::make_shared<const GridHamiltonianCycle4D>(size_);
+        bestAction_ = EstimateBestAction();
+    }
+
+    /// Set cache of best actions, may be shared between any simulations on the same thread.
+    /// Levels are told apart by level hash, board size and settings that affect best action are mixed into the key.
+    /// Path returned by GetPath is not updated when cached action is used.
+    void SetActionCache(ea::shared_ptr<ActionCache> actionCache) { actionCache_ = ea::move(actionCache); }
+
+    /// Copy settings, level and predefined targets from another simulation of the same size.
+    void CopySettings(const GameSimulation& other)
+    {
+        assert(size_ == other.size_);
+        animationSettings_ = other.animationSettings_;
+        lengthIncrement_ = other.lengthIncrement_;
+        enableRolls_ = other.enableRolls_;
+        avoidTraps_ = other.avoidTraps_;
+        autopilotMode_ = other.autopilotMode_;
+        cycle_ = other.cycle_;
+        numTargets_ = other.numTargets_;
+        if (topology_.IsWrapAround() != other.topology_.IsWrapAround())
+            SetWrapAround(other.topology_.IsWrapAround());
+        SetLevel(other.GetLevel());
+        obstacleFreeCells_ = other.obstacleFreeCells_;
+        targets_.assign(other.targets_.begin(), other.targets_.end());
+    }
+
+    void SetAnimationSettings(const AnimationSettings& animationSettings)
+    {
+        animationSettings_ = animationSettings;
+    }
+
+    void SetNextAction(UserAction action)
+    {
+        if (!gameOver_)
+            nextAction_ = action;
+    }
+
+    void UpdateCamera(float blendFactor, float timeStep)
+    {
+        const float smoothingConstant = 5.0f;
+        camera_.UpdateSmoothCamera(blendFactor, timeStep, smoothingConstant);
+    }
+
+    void Tick()
+    {
+        TickDelta* delta = BeginTickDelta();
+
+        // if the next action lead to immediate death, rollback it
+        if (!gameOver_)
+        {
+            const RotationDelta4D testRotationDelta = GetActionRotation(nextAction_);
+            const GridRotationIndex testRotation = ComposeRotations(camera_.GetCurrentRotation(), testRotationDelta.rotation_);
+            const GridDirection4D testDirection = RotateDirection(testRotation, MakeGridDirection(2, 1));
+            if (IsOutside(topology_.Step(camera_.GetCurrentPosition(), DirectionToIntVector(testDirection))))
+                nextAction_ = UserAction::None;
+        }
+
+        // Apply user action
+        const bool move = !gameOver_;
+        const RotationDelta4D rotationDelta = GetActionRotation(nextAction_);
+        const GridRotationIndex oldRotation = camera_.GetCurrentRotation();
+        nextAction_ = UserAction::None;
+        deathAnimation_ = false;
+        camera_.Step(rotationDelta, move);
+        camera_.WrapPosition(topology_.Step(camera_.GetCurrentPosition(), IntVector4{}));
+        hash_ ^= GetZobristKey(ZobristFeature::Rotation, oldRotation);
+        hash_ ^= GetZobristKey(ZobristFeature::Rotation, camera_.GetCurrentRotation());
+
+        // Store previous state
+        snake_.CommitState();
+
+        if (gameOver_)
+            return;
+
+        // Move snake. Head collides if it enters occupied cell, unless the cell is released by tail below
+        bool headCollided{};
+        {
+            const IntVector4 newPosition = camera_.GetCurrentPosition();
+            const GridDirection4D prevDirection = ReverseDirection(snake_[0].beginFrameOffset_);
+            const GridDirection4D newDirection = camera_.GetCurrentHeading();
+
+            SnakeElement element;
+            element.position_ = newPosition;
+            element.beginFrameRotation_ = RotateCubeFrame(snake_[0].beginFrameRotation_, prevDirection, newDirection);
+            element.beginFrameOffset_ = ReverseDirection(newDirection);
+            hash_ ^= GetZobristKey(ZobristFeature::HeadCell, GetCellIndex(GetSnakeHead()));
+            snake_.PushFront(element);
+            hash_ ^= GetZobristKey(ZobristFeature::HeadCell, GetCellIndex(newPosition));
+            hash_ ^= GetZobristKey(ZobristFeature::SnakeCell, GetCellIndex(newPosition));
+
+            const bool headCellFree = !IsOutside(newPosition) && freeCells_.Contains(newPosition);
+            headCollided = !headCellFree;
+            if (delta)
+                delta->flags_ |= TickHeadPushed | (headCellFree ? TickHeadCellTaken : 0);
+
+            if (!IsOutside(newPosition))
+            {
+                freeCells_.Remove(newPosition);
+                freeSpace_.Occupy(newPosition);
+            }
+        }
+
+        if (!IsOutside(GetSnakeHead()) && targetIndex_.Contains(GetSnakeHead()))
+        {
+            // Generate new target position
+            auto newTarget = GetNextTargetPosition();
+            if (!newTarget.second && targetPositions_.size() == 1)
+            {
+                gameOver_ = true;
+                return;
+            }
+
+            const auto eatenIter = ea::find(targetPositions_.begin(), targetPositions_.end(), GetSnakeHead());
+            if (delta)
+            {
+                delta->flags_ |= TickTargetEaten | (newTarget.second ? 0 : TickTargetErased);
+                delta->eatenTarget_ = *eatenIter;
+                delta->eatenTargetIndex_ = eatenIter - targetPositions_.begin();
+            }
+            hash_ ^= GetZobristKey(ZobristFeature::TargetCell, GetCellIndex(*eatenIter));
+            targetIndex_.Remove(*eatenIter);
+            if (newTarget.second)
+            {
+                *eatenIter = newTarget.first;
+                targetIndex_.Insert(newTarget.first);
+                hash_ ^= GetZobristKey(ZobristFeature::TargetCell, GetCellIndex(newTarget.first));
+            }
+            else
+            {
+                // No room for distinct target, continue with fewer targets
+                targetPositions_.erase(eatenIter);
+                currentTarget_ = 0;
+            }
+
+            // Request growth
+            SetPendingGrowth(pendingGrowth_ + lengthIncrement_);
+        }
+
+        // Remove tail segment if doesn't grow
+        if (pendingGrowth_ == 0)
+        {
+            const IntVector4 tailPosition = snake_.Back().position_;
+            if (delta)
+            {
+                delta->flags_ |= TickTailPopped;
+                delta->tail_ = snake_.Back();
+            }
+            snake_.PopBack();
+            hash_ ^= GetZobristKey(ZobristFeature::SnakeCell, GetCellIndex(tailPosition));
+
+            // Head may have just moved into the cell released by tail
+            if (tailPosition != GetSnakeHead())
+            {
+                freeCells_.Insert(tailPosition);
+                freeSpace_.Free(tailPosition);
+            }
+            else if (!IsOutside(tailPosition))
+                headCollided = false;
+        }
+        else
+            SetPendingGrowth(pendingGrowth_ - 1);
+
+        // Check for collision
+        if (headCollided)
+        {
+            gameOver_ = true;
+            deathAnimation_ = true;
+        }
+
+        // Update path
+        if (!gameOver_ && updateBestAction_)
+            bestAction_ = EstimateCachedBestAction();
+    }
+
+    UserAction GetNextAction() const { return nextAction_; }
+
+    UserAction GetBestAction() const { return bestAction_; }
+
+    /// Set best action for current state estimated outside of the simulation. Action is cached if action cache is set.
+    void SetBestAction(UserAction action)
+    {
+        bestAction_ = action;
+        if (actionCache_)
+            actionCache_->Store(GetActionCacheKey(), action);
+    }
+
+    /// Take best action for current state from the cache. Previous best action is kept if the state was not seen before.
+    /// Used while best action is estimated outside of the simulation. Return whether the action was cached.
+    bool UpdateCachedBestAction()
+    {
+        return actionCache_ && actionCache_->Find(GetActionCacheKey(), bestAction_);
+    }
+
+    /// Return best action from the cache if the state was seen before, estimate and cache it otherwise.
+    UserAction EstimateCachedBestAction()
+    {
+        // Hamiltonian cycle autopilot is cheaper than lookup and depends on tail order that is not hashed
+        if (!actionCache_ || autopilotMode_ != AutopilotMode::PathFinder)
+            return EstimateBestAction();
+
+        const unsigned long long key = GetActionCacheKey();
+        UserAction action{};
+        if (actionCache_->Find(key, action))
+        {
+            cachedPathOutdated_ = true;
+            return action;
+        }
+
+        // Path finder reuses previous path, which is not followed while actions come from the cache
+        if (cachedPathOutdated_)
+        {
+            pathFinder_.ClearPath();
+            cachedPathOutdated_ = false;
+        }
+
+        action = EstimateBestAction();
+        actionCache_->Store(key, action);
+        return action;
+    }
+
+    UserAction EstimateBestAction()
+    {
+        const IntVector4& startPosition = camera_.GetCurrentPosition();
+        if (IsOutside(startPosition))
+            return UserAction::None;
+
+        if (autopilotMode_ == AutopilotMode::HamiltonianCycle)
+        {
+            const IntVector4 nextPosition = GetNextCyclePosition();
+            if (!IsOutside(nextPosition) && !IsOccupied(nextPosition))
+                return GetActionToNeighbor(nextPosition);
+            // Initial snake is not laid along the cycle yet, let path finder lead
+        }
+
+        const UserAction action = EstimatePathAction();
+        return avoidTraps_ ? AvoidTrap(action) : action;
+    }
+
+    /// Return action that follows the shortest path to the target.
+    UserAction EstimatePathAction()
+    {
+        const IntVector4& startPosition = camera_.GetCurrentPosition();
+        const IntVector4& startDirection = camera_.GetCurrentDirection();
+        const auto checkCell = [&](const IntVector4& position) { return IsValidHeadPosition(position); };
+
+        // Find path, do nothing if fail
+        if (targetPositions_.size() > 1)
+        {
+            // Single search towards the nearest target, goal is known when path is found
+            const auto findNearestTarget = [&](const IntVector4& position) { return targetIndex_.FindNearest(position); };
+            if (!pathFinder_.UpdatePathToNearest(startPosition, startDirection, findNearestTarget, checkCell))
+                return UserAction::None;
+
+            const ea::span<const IntVector4> path = pathFinder_.GetPath();
+            if (!path.empty())
+                currentTarget_ = ea::find(targetPositions_.begin(), targetPositions_.end(), path.back()) - targetPositions_.begin();
+        }
+        else if (!pathFinder_.UpdatePath(startPosition, startDirection, targetPositions_[0], checkCell))
+            return UserAction::None;
+
+        const IntVector4 offset = pathFinder_.GetNextCellOffset();
+        if (offset != IntVector4{})
+        {
+            const UserAction action = GetActionToNeighbor(topology_.Step(startPosition, offset));
+            if (action != UserAction::None)
+                return action;
+        }
+
+        // Check for roll
+        const IntVector4 targetDelta = topology_.GetDelta(startPosition, GetTargetPosition());
+        const int offsetX = DotProduct(targetDelta, camera_.GetCurrentRight());
+        const int offsetW = DotProduct(targetDelta, camera_.GetCurrentBlue());
+        if (enableRolls_ && offsetX == 0 && offsetW != 0)
+            return UserAction::XRoll;
+
+        return UserAction::None;
+    }
+
+    CurrentAnimationType GetCurrentAnimationType(float blendFactor) const
+    {
+        return Urho3D::GetCurrentAnimationType(camera_, animationSettings_, blendFactor);
+    }
+
+    unsigned GetSnakeLength() const { return snake_.Size(); }
+
+    IntVector4 GetSnakeHead() const { return snake_.Front().position_; }
+
+    int GetSize() const { return size_; }
+
+    unsigned GetLengthIncrement() const { return lengthIncrement_; }
+
+    unsigned GetNumTargets() const { return numTargets_; }
+
+    const ea::vector<IntVector4>& GetPredefinedTargets() const { return targets_; }
+
+    unsigned long long GetSeed() const { return seed_; }
+
+    /// Return Zobrist hash of the state that affects future ticks, maintained incrementally.
+    unsigned long long GetHash() const { return hash_; }
+
+    /// Return 16-bit checksum of the state for lockstep verification.
+    /// Hash is updated incrementally by Tick, so the checksum costs a few operations.
+    unsigned short GetChecksum() const
+    {
+        const unsigned long long folded = hash_ ^ (hash_ >> 32);
+        return static_cast<unsigned short>(folded ^ (folded >> 16));
+    }
+
+    /// Calculate Zobrist hash from scratch by walking the whole snake.
+    unsigned long long ComputeHash() const
+    {
+        unsigned long long hash = 0;
+        for (unsigned i = 0; i < snake_.Size(); ++i)
+            hash ^= GetZobristKey(ZobristFeature::SnakeCell, GetCellIndex(snake_[i].position_));
+        hash ^= GetZobristKey(ZobristFeature::HeadCell, GetCellIndex(GetSnakeHead()));
+        for (const IntVector4& targetPosition : targetPositions_)
+            hash ^= GetZobristKey(ZobristFeature::TargetCell, GetCellIndex(targetPosition));
+        hash ^= GetZobristKey(ZobristFeature::Rotation, camera_.GetCurrentRotation());
+        hash ^= GetZobristKey(ZobristFeature::Growth, pendingGrowth_);
+        return hash;
+    }
+
+    bool IsGameOver() const { return gameOver_; }
+
+    bool HasDeathAnimation() const { return deathAnimation_; }
+
+    const AnimationSettings& GetAnimationSettings() const { return animationSettings_; }
+
+    const GridCamera4D& GetCamera() const { return camera_; }
+
+    const SnakeBody& GetSnake() const { return snake_; }
+
+    /// Return target the autopilot currently goes to.
+    const IntVector4& GetTargetPosition() const { return targetPositions_[currentTarget_]; }
+
+    const ea::vector<IntVector4>& GetTargetPositions() const { return targetPositions_; }
+
+    bool IsTarget(const IntVector4& position) const { return !IsOutside(position) && targetIndex_.Contains(position); }
+
+    /// Return target nearest to the position by Manhattan distance.
+    IntVector4 FindNearestTarget(const IntVector4& position) const
+    {
+        return targetPositions_.size() > 1 ? targetIndex_.FindNearest(position) : targetPositions_[0];
+    }
+
+    ea::span<const IntVector4> GetPath() const { return pathFinder_.GetPath(); }
+
+    const GridTopology4D& GetTopology() const { return topology_; }
+
+    /// Return level settings of the simulation. Predefined targets are not included.
+    GameLevel GetLevel() const
+    {
+        GameLevel level;
+        level.size_ = size_;
+        level.startPosition_ = startPosition_;
+        level.startRotation_ = startRotation_;
+        level.obstacles_ = obstacles_;
+        level.hash_ = levelHash_;
+        return level;
+    }
+
+    const GridObstacleSet4D& GetObstacles() const { return obstacles_; }
+
+    /// Return whether the cell is outside of the board, never true on wrapped board.
+    bool IsOutside(const IntVector4& position) const { return topology_.IsOutside(position); }
+
+    /// Return whether the cell inside the board is occupied by snake, including head, or obstacle.
+    bool IsOccupied(const IntVector4& position) const { return !freeCells_.Contains(position); }
+
+    /// Return whether snake head may enter the cell: the cell is on the board and is not an obstacle or snake body.
+    /// Occupancy of free cells is queried, so it is O(1) while the snake is alive.
+    bool IsValidHeadPosition(const IntVector4& position) const
+    {
+        if (IsOutside(position))
+            return false;
+
+        // Dead head may share the cell with body or obstacle, walk the body only after game over
+        if (position == GetSnakeHead())
+            return !gameOver_ || Urho3D::IsValidHeadPosition(topology_, obstacles_, snake_, position);
+        return freeCells_.Contains(position);
+    }
+
+private:
+    enum TickDeltaFlag : unsigned char
+    {
+        TickHeadPushed = 1 << 0,
+        /// Head entered free cell, so the cell is released when the head is undone.
+        TickHeadCellTaken = 1 << 1,
+        TickTailPopped = 1 << 2,
+        TickTargetEaten = 1 << 3,
+        /// Eaten target was not respawned.
+        TickTargetErased = 1 << 4,
+        TickGameOver = 1 << 5,
+        TickDeathAnimation = 1 << 6,
+    };
+
+    /// Store state that is overwritten by the tick. Return null if rewind is disabled.
+    TickDelta* BeginTickDelta()
+    {
+        if (tickDeltas_.empty())
+            return nullptr;
+
+        // Oldest tick is forgotten when the ring is full
+        const unsigned capacity = tickDeltas_.size();
+        if (numTickDeltas_ == capacity)
+        {
+            firstTickDelta_ = (firstTickDelta_ + 1) % capacity;
+            --numTickDeltas_;
+        }
+
+        TickDelta& delta = tickDeltas_[(firstTickDelta_ + numTickDeltas_) % capacity];
+        ++numTickDeltas_;
+
+        delta.hash_ = hash_;
+        delta.random_ = random_;
+        delta.pendingGrowth_ = pendingGrowth_;
+        delta.nextTargetIndex_ = nextTargetIndex_;
+        delta.currentTarget_ = currentTarget_;
+        delta.cameraRotation_ = camera_.GetCurrentRotation();
+        delta.nextAction_ = nextAction_;
+        delta.bestAction_ = bestAction_;
+        delta.flags_ = (gameOver_ ? TickGameOver : 0) | (deathAnimation_ ? TickDeathAnimation : 0);
+        return &delta;
+    }
+
+    /// Undo changes of the tick in reverse order.
+    void UndoTick(const TickDelta& delta)
+    {
+        if (delta.flags_ & TickTailPopped)
+        {
+            snake_.PushBack(delta.tail_);
+            // Tail cell may be occupied already if the head has moved into it
+            freeCells_.Remove(delta.tail_.position_);
+        }
+
+        if (delta.flags_ & TickTargetEaten)
+        {
+            if (delta.flags_ & TickTargetErased)
+                targetPositions_.insert(targetPositions_.begin() + delta.eatenTargetIndex_, delta.eatenTarget_);
+            else
+            {
+                targetIndex_.Remove(targetPositions_[delta.eatenTargetIndex_]);
+                targetPositions_[delta.eatenTargetIndex_] = delta.eatenTarget_;
+            }
+            targetIndex_.Insert(delta.eatenTarget_);
+        }
+
+        if (delta.flags_ & TickHeadPushed)
+        {
+            if (delta.flags_ & TickHeadCellTaken)
+                freeCells_.Insert(GetSnakeHead());
+            snake_.PopFront();
+        }
+
+        camera_.Restore(GetSnakeHead(), delta.cameraRotation_);
+        hash_ = delta.hash_;
+        random_ = delta.random_;
+        pendingGrowth_ = delta.pendingGrowth_;
+        nextTargetIndex_ = delta.nextTargetIndex_;
+        currentTarget_ = delta.currentTarget_;
+        nextAction_ = delta.nextAction_;
+        bestAction_ = delta.bestAction_;
+        gameOver_ = (delta.flags_ & TickGameOver) != 0;
+        deathAnimation_ = (delta.flags_ & TickDeathAnimation) != 0;
+    }
+
+    static IntVector4 GetDefaultStartPosition(int size)
+    {
+        return { size / 2, size / 2, size * 1 / 4, size / 2 };
+    }
+
+    /// Mark all cells except obstacles and snake as free.
+    void ResetFreeCells()
+    {
+        if (!obstacleFreeCells_)
+        {
+            auto obstacleFreeCells = ea::make_shared<GridFreeCellSet4D>(size_);
+            obstacles_.ForEach([&](const IntVector4& position) { obstacleFreeCells->Remove(position); });
+            obstacleFreeCells_ = obstacleFreeCells;
+        }
+
+        freeCells_ = *obstacleFreeCells_;
+        for (unsigned i = 0; i < snake_.Size(); ++i)
+        {
+            if (!IsOutside(snake_[i].position_))
+                freeCells_.Remove(snake_[i].position_);
+        }
+        freeSpace_.Invalidate();
+    }
+
+    /// Return flattened index of the cell, all cells outside share one index.
+    unsigned long long GetCellIndex(const IntVector4& pos) const
+    {
+        const auto size = static_cast<unsigned long long>(size_);
+        if (IsOutside(pos))
+            return size * size * size * size;
+        return FlattenGridIndex(pos, size_);
+    }
+
+    void SetPendingGrowth(unsigned pendingGrowth)
+    {
+        hash_ ^= GetZobristKey(ZobristFeature::Growth, pendingGrowth_);
+        pendingGrowth_ = pendingGrowth;
+        hash_ ^= GetZobristKey(ZobristFeature::Growth, pendingGrowth_);
+    }
+
+    /// Return key of current state in action cache.
+    /// Same state of different levels, board sizes or settings that affect best action estimation has different key.
+    unsigned long long GetActionCacheKey() const
+    {
+        const unsigned settings = static_cast<unsigned>(size_) << 8
+            | static_cast<unsigned>(autopilotMode_) << 3
+            | (avoidTraps_ ? 1u << 2 : 0u)
+            | (topology_.IsWrapAround() ? 1u << 1 : 0u)
+            | (enableRolls_ ? 1u : 0u);
+        return hash_ ^ levelHash_ ^ GetZobristKey(ZobristFeature::Settings, settings);
+    }
+
+    /// Return size of free space entered by snake head after the action.
+    unsigned GetFreeSpaceAfterAction(UserAction action) const
+    {
+        const GridRotationIndex rotation = ComposeRotations(camera_.GetCurrentRotation(), GetActionRotation(action).rotation_);
+        const IntVector4 nextPosition = topology_.Step(camera_.GetCurrentPosition(), DirectionToIntVector(RotateDirection(rotation, MakeGridDirection(2, 1))));
+        return !IsOutside(nextPosition) ? freeSpace_.GetComponentSize(nextPosition) : 0;
+    }
+
+    /// Replace action that leads into free space smaller than the snake with the action that leads into the largest space.
+    UserAction AvoidTrap(UserAction action)
+    {
+        // Components of large boards are not tracked, rebuild would scan every cell
+        if (!IsDenseGrid(size_))
+            return action;
+
+        // Components are rebuilt only after reset or restore
+        if (!freeSpace_.IsValid())
+            freeSpace_.Rebuild([this](const IntVector4& position) { return freeCells_.Contains(position); });
+
+        unsigned bestSpace = GetFreeSpaceAfterAction(action);
+        if (bestSpace >= snake_.Size())
+            return action;
+
+        UserAction bestAction = action;
+        for (unsigned i = 0; i < static_cast<unsigned>(UserAction::Count); ++i)
+        {
+            const auto candidate = static_cast<UserAction>(i);
+            const unsigned space = GetFreeSpaceAfterAction(candidate);
+            if (space > bestSpace)
+            {
+                bestAction = candidate;
+                bestSpace = space;
+            }
+        }
+        return bestAction;
+    }
+
+    /// Return action that moves head into adjacent cell, None for forward or backward cell.
+    UserAction GetActionToNeighbor(const IntVector4& position) const
+    {
+        // Convert offset to camera space
+        static const UserAction actionsByDirection[NumGridDirections] = {
+            UserAction::Left,  // -X
+            UserAction::Right, // +X
+            UserAction::Down,  // -Y
+            UserAction::Up,    // +Y
+            UserAction::None,  // -Z, cannot turn back
+            UserAction::None,  // +Z
+            UserAction::Red,   // -W
+            UserAction::Blue,  // +W
+        };
+
+        const IntVector4 offset = topology_.GetDelta(camera_.GetCurrentPosition(), position);
+        const GridRotationIndex inverseRotation = InvertRotation(camera_.GetCurrentRotation());
+        const GridDirection4D offsetInCameraSpace = RotateDirection(inverseRotation, IntVectorToDirection(offset));
+        return actionsByDirection[offsetInCameraSpace];
+    }
+
+    /// Return next head position along Hamiltonian cycle, taking shortcuts that keep the body ahead of the tail.
+    IntVector4 GetNextCyclePosition() const
+    {
+        const GridHamiltonianCycle4D& cycle = *cycle_;
+        const IntVector4& headPosition = camera_.GetCurrentPosition();
+        const bool targetInHole = cycle.HasHole() && IsTarget(cycle.GetHole());
+
+        IntVector4 bestPosition = cycle.GetNext(headPosition);
+        if (targetInHole && bestPosition == cycle.GetBypass())
+            bestPosition = cycle.GetHole();
+
+        // Shortcuts are safe only when cells up to the tail are free and the snake is short
+        const unsigned snakeLength = snake_.Size() + pendingGrowth_;
+        if (snakeLength * 2 >= cycle.GetLength())
+            return bestPosition;
+
+        unsigned targetDistance = M_MAX_UNSIGNED;
+        for (const IntVector4& targetPosition : targetPositions_)
+            targetDistance = ea::min(targetDistance, cycle.GetDistance(headPosition, targetPosition));
+        const unsigned tailDistance = cycle.GetDistance(headPosition, snake_.Back().position_);
+        const unsigned reserve = pendingGrowth_ + lengthIncrement_ + ShortcutTailReserve;
+        unsigned bestDistance = cycle.GetDistance(headPosition, bestPosition);
+        for (unsigned i = 0; i < NumGridDirections; ++i)
+        {
+            const IntVector4 position = topology_.Step(headPosition, DirectionToIntVector(static_cast<GridDirection4D>(i)));
+            if (IsOutside(position) || IsOccupied(position))
+                continue;
+
+            // Hole is only entered to eat the target, in place of bypass cell
+            if (cycle.HasHole() && position == (targetInHole ? cycle.GetBypass() : cycle.GetHole()))
+                continue;
+
+            const unsigned distance = cycle.GetDistance(headPosition, position);
+            if (distance > bestDistance && distance <= targetDistance && distance + reserve < tailDistance)
+            {
+                bestPosition = position;
+                bestDistance = distance;
+            }
+        }
+        return bestPosition;
+    }
+
+    void AddTarget(const IntVector4& position)
+    {
+        targetPositions_.push_back(position);
+        targetIndex_.Insert(position);
+    }
+
+    /// Return position of new target that does not coincide with existing targets.
+    ea::pair<IntVector4, bool> GetNextTargetPosition()
+    {
+        while (nextTargetIndex_ < targets_.size())
+        {
+            const IntVector4& position = targets_[nextTargetIndex_++];
+            if (!targetIndex_.Contains(position))
+                return { position, true };
+        }
+
+        return GetAvailablePosition();
+    }
+
+    /// Return uniformly distributed free cell that is not a target. Fail only if there is no such cell.
+    ea::pair<IntVector4, bool> GetAvailablePosition()
+    {
+        return freeCells_.GetRandomCellExcept(random_, targetPositions_);
+    }
+
+    int size_{};
+    GridTopology4D topology_;
+    AnimationSettings animationSettings_;
+
+    GridCamera4D camera_;
+
+    UserAction nextAction_{};
+    UserAction bestAction_{};
+    bool gameOver_{};
+    bool deathAnimation_{};
+
+    unsigned lengthIncrement_{ 3 };
+    unsigned numTargets_{ 1 };
+    bool enableRolls_{ true };
+    bool updateBestAction_{ true };
+    bool avoidTraps_{ true };
+    AutopilotMode autopilotMode_{};
+    /// Generated on demand and shared between copies of the simulation.
+    ea::shared_ptr<const GridHamiltonianCycle4D> cycle_;
+    ea::shared_ptr<ActionCache> actionCache_;
+    bool cachedPathOutdated_{};
+    unsigned pendingGrowth_{};
+    SnakeBody snake_;
+
+    /// Static obstacles and start pose of the level.
+    GridObstacleSet4D obstacles_;
+    IntVector4 startPosition_{};
+    GridRotationIndex startRotation_{ IdentityGridRotation };
+    unsigned long long levelHash_{};
+
+    /// Predefined targets, random targets are spawned after them.
+    ea::vector<IntVector4> targets_;
+    unsigned nextTargetIndex_{};
+    /// Targets on the board and the one autopilot goes to.
+    ea::vector<IntVector4> targetPositions_;
+    unsigned currentTarget_{};
+    /// Same targets bucketed for nearest target queries.
+    GridPointIndex4D targetIndex_;
+    GridPathFinder4D pathFinder_;
+    GridFreeCellSet4D freeCells_;
+    /// Free cells of the level without snake, shared between simulations with the same obstacles.
+    ea::shared_ptr<const GridFreeCellSet4D> obstacleFreeCells_;
+    /// Connected free space, updated incrementally once built. Not tracked on large boards.
+    GridFreeSpace4D freeSpace_;
+
+    unsigned long long seed_{};
+    RandomGenerator random_;
+    unsigned long long hash_{};
+
+    /// Ring of deltas of last ticks, oldest first.
+    ea::vector<TickDelta> tickDeltas_;
+    unsigned firstTickDelta_{};
+    unsigned numTickDeltas_{};
+};
+
+}
@@ -3,19 +3,30 @@
 namespace Urho3D
 {
 
-void GridCamera4D::Reset(const IntVector4& position, const IntVector4& direction, const Matrix4& rotation)
+void GridCamera4D::Reset(const IntVector4& position, const IntVector4& direction, GridRotationIndex rotation)
 {
     currentDirection_ = direction;
 
     previousPosition_ = position;
     currentPosition_ = position;
 
-    previousRotation_ = { rotation, Vector4::ZERO };
-    currentRotation_ = { rotation, Vector4::ZERO };
+    previousRotation_ = rotation;
+    currentRotation_ = rotation;
     rotationDelta_ = {};
 
     smoothCameraPosition_ = IndexToPosition(currentPosition_);
-    smoothCameraRotation_ = currentRotation_;
+    smoothCameraRotation_ = { GridRotation4D::FromIndex(currentRotation_).ToMatrix(), Vector4::ZERO };
+}
+
+void GridCamera4D::Restore(const IntVector4& position, GridRotationIndex rotation)
+{
+    previousPosition_ = position;
+    currentPosition_ = position;
+
+    previousRotation_ = rotation;
+    currentRotation_ = rotation;
+    currentDirection_ = GetCurrentDirection();
+    rotationDelta_ = {};
 }
 
 void GridCamera4D::Step(const RotationDelta4D& delta, bool move)
@@ -23,19 +34,46 @@ void GridCamera4D::Step(const RotationDelta4D& delta, bool move)
     rotationDelta_ = delta;
 
     previousRotation_ = currentRotation_;
-    currentRotation_ = currentRotation_ * rotationDelta_.AsMatrix(1.0f);
+    currentRotation_ = ComposeRotations(currentRotation_, rotationDelta_.rotation_);
     currentDirection_ = GetCurrentDirection();
 
-    // Snap to axises to avoid precision loss
-    float* data = &currentRotation_.rotation_.m00_;
-    for (int i = 0; i < 16; ++i)
-        data[i] = Round(data[i]);
-
     previousPosition_ = currentPosition_;
     if (move)
         currentPosition_ = currentPosition_ + currentDirection_;
 }
 
+void GridCamera4D::CopyGridState(const GridCamera4D& other, int wrapSize)
+{
+    currentDirection_ = other.currentDirection_;
+    previousPosition_ = other.previousPosition_;
+    currentPosition_ = other.currentPosition_;
+    previousRotation_ = other.previousRotation_;
+    currentRotation_ = other.currentRotation_;
+    rotationDelta_ = other.rotationDelta_;
+
+    if (wrapSize > 0)
+    {
+        const auto wrapCoordinate = [&](float& smoothCoordinate, float coordinate)
+        {
+            smoothCoordinate -= RoundToInt((smoothCoordinate - coordinate) / wrapSize) * wrapSize;
+        };
+
+        const Vector4 position = GetWorldPosition(0.0f);
+        wrapCoordinate(smoothCameraPosition_.x_, position.x_);
+        wrapCoordinate(smoothCameraPosition_.y_, position.y_);
+        wrapCoordinate(smoothCameraPosition_.z_, position.z_);
+        wrapCoordinate(smoothCameraPosition_.w_, position.w_);
+    }
+}
+
+void GridCamera4D::WrapPosition(const IntVector4& position)
+{
+    const IntVector4 offset = position - currentPosition_;
+    previousPosition_ = previousPosition_ + offset;
+    currentPosition_ = position;
+    smoothCameraPosition_ += IntVectorToVector4(offset);
+}
+
 void GridCamera4D::UpdateSmoothCamera(float blendFactor, float timeStep, float smoothingConstant)
 {
     const float lerpConstant = 1.0f - Clamp(powf(2.0f, -timeStep * smoothingConstant), 0.0f, 1.0f);
@@ -51,7 +89,8 @@ Vector4 GridCamera4D::GetWorldPosition(float blendFactor) const
 
 Matrix4x5 GridCamera4D::GetWorldRotation(float blendFactor) const
 {
-    return previousRotation_ * rotationDelta_.AsMatrix(blendFactor);
+    const Matrix4x5 previousRotation{ GridRotation4D::FromIndex(previousRotation_).ToMatrix(), Vector4::ZERO };
+    return previousRotation * rotationDelta_.AsMatrix(blendFactor);
 }
 
 Matrix4x5 GridCamera4D::GetViewMatrix(float translationBlendFactor, float rotationBlendFactor) const
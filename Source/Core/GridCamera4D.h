@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Math4D.h"
+#include "GridRotation4D.h"
 
 namespace Urho3D
 {
@@ -10,6 +11,19 @@ struct RotationDelta4D
     int axis1_{};
     int axis2_{};
     float angle_{};
+    GridRotationIndex rotation_{};
+
+    /// Make quarter turn or no rotation if angle is zero.
+    static constexpr RotationDelta4D Make(int axis1, int axis2, float angle)
+    {
+        assert(angle == 0.0f || angle == 90.0f || angle == -90.0f);
+        const int sign = angle > 0.0f ? -1 : 1;
+        const GridRotation4D rotation = angle != 0.0f
+            ? GridRotation4D::MakeDelta(MakeGridDirection(axis1, 1), MakeGridDirection(axis2, sign))
+            : GridRotation4D::MakeIdentity();
+        return { axis1, axis2, angle, rotation.ToIndex() };
+    }
+
     Matrix4x5 AsMatrix(float factor) const { return angle_ != 0.0f ? Matrix4x5::MakeRotation(axis1_, axis2_, factor * angle_) : Matrix4x5::MakeIdentity(); }
 };
 
@@ -31,10 +45,20 @@ inline IntVector4 PositionToIndex(const Vector4& position)
 class GridCamera4D
 {
 public:
-    void Reset(const IntVector4& position, const IntVector4& direction, const Matrix4& rotation);
+    void Reset(const IntVector4& position, const IntVector4& direction, GridRotationIndex rotation);
+
+    /// Jump to position and rotation without animation. Smooth camera is not affected.
+    void Restore(const IntVector4& position, GridRotationIndex rotation);
 
     void Step(const RotationDelta4D& delta, bool move);
 
+    /// Copy position, rotation and animation of another camera. Smooth camera is not affected.
+    /// If board wraps around with given size, smooth camera is moved to equivalent position nearest to the new one.
+    void CopyGridState(const GridCamera4D& other, int wrapSize);
+
+    /// Move to equivalent position on wrapped board. Animation continues as if the camera has not jumped.
+    void WrapPosition(const IntVector4& position);
+
     void UpdateSmoothCamera(float blendFactor, float timeStep, float smoothingConstant);
 
     Vector4 GetWorldPosition(float blendFactor) const;
@@ -53,26 +77,32 @@ public:
 
     const IntVector4& GetCurrentPosition() const { return currentPosition_; }
 
-    IntVector4 GetCurrentDirection() const { return RoundVector4(currentRotation_ * Vector4(0, 0, 1, 0)); }
+    GridRotationIndex GetCurrentRotation() const { return currentRotation_; }
 
-    IntVector4 GetCurrentUp() const { return RoundVector4(currentRotation_ * Vector4(0, 1, 0, 0)); }
+    GridDirection4D GetCurrentHeading() const { return RotateDirection(currentRotation_, MakeGridDirection(2, 1)); }
 
-    IntVector4 GetCurrentRight() const { return RoundVector4(currentRotation_ * Vector4(1, 0, 0, 0)); }
+    IntVector4 GetCurrentDirection() const { return GetCurrentAxis(2); }
 
-    IntVector4 GetCurrentBlue() const { return RoundVector4(currentRotation_ * Vector4(0, 0, 0, 1)); }
+    IntVector4 GetCurrentUp() const { return GetCurrentAxis(1); }
+
+    IntVector4 GetCurrentRight() const { return GetCurrentAxis(0); }
+
+    IntVector4 GetCurrentBlue() const { return GetCurrentAxis(3); }
 
     bool IsRotating() const { return rotationDelta_.angle_ > M_EPSILON; }
 
     bool IsColorRotating() const { return rotationDelta_.angle_ != 0.0f && (rotationDelta_.axis1_ == 3 || rotationDelta_.axis2_ == 3); }
 
 private:
+    IntVector4 GetCurrentAxis(int axis) const { return DirectionToIntVector(RotateDirection(currentRotation_, MakeGridDirection(axis, 1))); }
+
     IntVector4 currentDirection_{};
 
     IntVector4 previousPosition_;
     IntVector4 currentPosition_;
 
-    Matrix4x5 previousRotation_;
-    Matrix4x5 currentRotation_;
+    GridRotationIndex previousRotation_{};
+    GridRotationIndex currentRotation_{};
     RotationDelta4D rotationDelta_;
 
     Vector4 smoothCameraPosition_;
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Math4D.h"
+
+#include <EASTL/numeric_limits.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Boards up to this number of cells use dense per-cell arrays where they are faster.
+static const unsigned long long MaxDenseGridCells = 1ull << 22;
+
+/// Return whether the board is small enough for dense per-cell arrays.
+inline bool IsDenseGrid(int gridSize)
+{
+    const auto size = static_cast<unsigned long long>(gridSize);
+    return size * size * size * size <= MaxDenseGridCells;
+}
+
+/// Sparse array over 4D grid cells split into hypercubic bricks of 2^ChunkBits cells along each axis.
+/// Bricks are allocated on first write and addressed by hash of brick coordinates,
+/// cells of untouched bricks read as default value. Memory is proportional to the touched area of the grid.
+/// Coordinates must be non-negative and less than 2^(16 + ChunkBits).
+/// Last accessed brick is cached, so only GetConcurrent may be called from many threads at once.
+template <class T, unsigned ChunkBits = 3>
+class GridChunkedArray4D
+{
+public:
+    static constexpr int ChunkSize = 1 << ChunkBits;
+    static constexpr unsigned CellsPerChunk = 1u << (4 * ChunkBits);
+
+    explicit GridChunkedArray4D(const T& defaultValue = T{})
+        : defaultValue_(defaultValue)
+    {
+    }
+
+    /// Reset all cells to default value. Bricks are kept for reuse.
+    void Clear()
+    {
+        chunkIndices_.clear();
+        numChunks_ = 0;
+        lastChunkKey_ = InvalidChunkKey;
+    }
+
+    /// Reset all cells to default value and release memory.
+    void Reset()
+    {
+        Clear();
+        chunks_.clear();
+        chunks_.shrink_to_fit();
+    }
+
+    const T& Get(const IntVector4& position) const
+    {
+        const unsigned chunkIndex = FindChunk(GetChunkKey(position));
+        return chunkIndex != InvalidChunkIndex ? chunks_[chunkIndex][GetLocalIndex(position)] : defaultValue_;
+    }
+
+    /// Same as Get, but does not touch the cache of the last brick.
+    const T& GetConcurrent(const IntVector4& position) const
+    {
+        const auto iter = chunkIndices_.find(GetChunkKey(position));
+        return iter != chunkIndices_.end() ? chunks_[iter->second][GetLocalIndex(position)] : defaultValue_;
+    }
+
+    /// Return reference to the cell, allocating its brick if needed.
+    T& GetOrCreate(const IntVector4& position)
+    {
+        const unsigned long long chunkKey = GetChunkKey(position);
+        unsigned chunkIndex = FindChunk(chunkKey);
+        if (chunkIndex == InvalidChunkIndex)
+        {
+            chunkIndex = AllocateChunk();
+            chunkIndices_.emplace(chunkKey, chunkIndex);
+            lastChunkKey_ = chunkKey;
+            lastChunkIndex_ = chunkIndex;
+        }
+        return chunks_[chunkIndex][GetLocalIndex(position)];
+    }
+
+    void Set(const IntVector4& position, const T& value) { GetOrCreate(position) = value; }
+
+    /// Return number of allocated bricks in use.
+    unsigned GetNumChunks() const { return numChunks_; }
+
+    const T& GetDefaultValue() const { return defaultValue_; }
+
+private:
+    static constexpr unsigned long long InvalidChunkKey = ea::numeric_limits<unsigned long long>::max();
+    static constexpr unsigned InvalidChunkIndex = M_MAX_UNSIGNED;
+    static constexpr int LocalMask = ChunkSize - 1;
+
+    static unsigned long long GetChunkKey(const IntVector4& position)
+    {
+        unsigned long long key = 0;
+        for (int i = 0; i < 4; ++i)
+            key |= static_cast<unsigned long long>(position[i] >> ChunkBits) << (16 * i);
+        return key;
+    }
+
+    static unsigned GetLocalIndex(const IntVector4& position)
+    {
+        unsigned index = 0;
+        for (int i = 3; i >= 0; --i)
+            index = (index << ChunkBits) | static_cast<unsigned>(position[i] & LocalMask);
+        return index;
+    }
+
+    unsigned FindChunk(unsigned long long chunkKey) const
+    {
+        if (chunkKey == lastChunkKey_)
+            return lastChunkIndex_;
+
+        const auto iter = chunkIndices_.find(chunkKey);
+        if (iter == chunkIndices_.end())
+            return InvalidChunkIndex;
+
+        lastChunkKey_ = chunkKey;
+        lastChunkIndex_ = iter->second;
+        return iter->second;
+    }
+
+    unsigned AllocateChunk()
+    {
+        if (numChunks_ == chunks_.size())
+            chunks_.emplace_back(CellsPerChunk, defaultValue_);
+        else
+            ea::fill(chunks_[numChunks_].begin(), chunks_[numChunks_].end(), defaultValue_);
+        return numChunks_++;
+    }
+
+    T defaultValue_{};
+
+    /// Index of brick in chunks_ for each allocated brick key.
+    ea::unordered_map<unsigned long long, unsigned> chunkIndices_;
+    /// Bricks in use followed by bricks kept for reuse.
+    ea::vector<ea::vector<T>> chunks_;
+    unsigned numChunks_{};
+
+    mutable unsigned long long lastChunkKey_{ InvalidChunkKey };
+    mutable unsigned lastChunkIndex_{ InvalidChunkIndex };
+};
+
+}
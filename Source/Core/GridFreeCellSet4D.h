@@ -0,0 +1,255 @@
+#pragma once
+
+#include "Math4D.h"
+#include "GridChunkedArray4D.h"
+
+#include <EASTL/span.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Set of free grid cells. Insertion and removal are O(1), uniform random sampling is O(1) while the board is mostly free.
+/// Small boards keep bitset of occupied cells, large boards keep only occupied cells in sparse bricks.
+/// Sampling depends only on the set of free cells and the generator, not on the order of insertions and removals.
+class GridFreeCellSet4D
+{
+    static constexpr unsigned BitsPerWord = 32;
+    /// Free cells are counted per group of words, so crowded small board is searched without full scan.
+    static constexpr unsigned WordsPerGroup = 64;
+    static constexpr unsigned CellsPerGroup = BitsPerWord * WordsPerGroup;
+    /// Number of rejected samples after which crowded small board is searched for k-th free cell.
+    static constexpr unsigned MaxDenseSamples = 8;
+    /// Number of rejected samples after which crowded large board is scanned for free cell.
+    static constexpr unsigned MaxSparseSamples = 64;
+
+public:
+    explicit GridFreeCellSet4D(int gridSize = 0)
+    {
+        Reset(gridSize);
+    }
+
+    /// Mark all cells as free.
+    void Reset(int gridSize)
+    {
+        assert(gridSize <= MaxGridSize);
+        gridSize_ = gridSize;
+        sparse_ = !IsDenseGrid(gridSize_);
+
+        const auto size = static_cast<unsigned long long>(gridSize_);
+        numCells_ = size * size * size * size;
+        numOccupiedCells_ = 0;
+        occupiedCells_.Clear();
+        if (sparse_)
+        {
+            occupiedBits_.clear();
+            groupFreeCounts_.clear();
+            return;
+        }
+
+        // Bits past the last cell are set, so they are never free
+        const auto numCells = static_cast<unsigned>(numCells_);
+        occupiedBits_.assign((numCells + BitsPerWord - 1) / BitsPerWord, 0u);
+        if (numCells % BitsPerWord != 0)
+            occupiedBits_.back() = M_MAX_UNSIGNED << (numCells % BitsPerWord);
+
+        groupFreeCounts_.resize((numCells + CellsPerGroup - 1) / CellsPerGroup);
+        for (unsigned i = 0; i < groupFreeCounts_.size(); ++i)
+            groupFreeCounts_[i] = ea::min(CellsPerGroup, numCells - i * CellsPerGroup);
+    }
+
+    bool Contains(const IntVector4& position) const
+    {
+        if (sparse_)
+            return !occupiedCells_.Get(position);
+
+        const unsigned index = FlattenIndex(position);
+        return !(occupiedBits_[index / BitsPerWord] & (1u << (index % BitsPerWord)));
+    }
+
+    void Insert(const IntVector4& position)
+    {
+        if (sparse_)
+        {
+            if (occupiedCells_.Get(position))
+            {
+                occupiedCells_.Set(position, 0);
+                --numOccupiedCells_;
+            }
+            return;
+        }
+
+        const unsigned index = FlattenIndex(position);
+        unsigned& word = occupiedBits_[index / BitsPerWord];
+        const unsigned bit = 1u << (index % BitsPerWord);
+        if (!(word & bit))
+            return;
+
+        word &= ~bit;
+        ++groupFreeCounts_[index / CellsPerGroup];
+        --numOccupiedCells_;
+    }
+
+    void Remove(const IntVector4& position)
+    {
+        if (sparse_)
+        {
+            if (!occupiedCells_.Get(position))
+            {
+                occupiedCells_.Set(position, 1);
+                ++numOccupiedCells_;
+            }
+            return;
+        }
+
+        const unsigned index = FlattenIndex(position);
+        unsigned& word = occupiedBits_[index / BitsPerWord];
+        const unsigned bit = 1u << (index % BitsPerWord);
+        if (word & bit)
+            return;
+
+        word |= bit;
+        --groupFreeCounts_[index / CellsPerGroup];
+        ++numOccupiedCells_;
+    }
+
+    bool IsEmpty() const { return Size() == 0; }
+
+    unsigned long long Size() const { return numCells_ - numOccupiedCells_; }
+
+    /// Return uniformly distributed free cell.
+    IntVector4 GetRandomCell(RandomGenerator& random) const
+    {
+        assert(!IsEmpty());
+        return sparse_ ? GetRandomSparseCell(random) : GetRandomDenseCell(random);
+    }
+
+    /// Return uniformly distributed free cell that is not excluded. Fail only if there is no such cell.
+    /// Excluded cells are few, e.g. targets, so they are taken out of the set while sampling.
+    ea::pair<IntVector4, bool> GetRandomCellExcept(RandomGenerator& random, ea::span<const IntVector4> excluded)
+    {
+        excludedCells_.clear();
+        for (const IntVector4& position : excluded)
+        {
+            if (IsInside(position, IntVector4{ 0, 0, 0, 0 }, IntVector4{ gridSize_, gridSize_, gridSize_, gridSize_ })
+                && Contains(position))
+            {
+                Remove(position);
+                excludedCells_.push_back(position);
+            }
+        }
+
+        ea::pair<IntVector4, bool> result{};
+        if (!IsEmpty())
+            result = { GetRandomCell(random), true };
+
+        for (const IntVector4& position : excludedCells_)
+            Insert(position);
+        return result;
+    }
+
+private:
+    IntVector4 GetRandomDenseCell(RandomGenerator& random) const
+    {
+        // Board is mostly free, so rejection sampling usually succeeds in a few attempts
+        const auto numCells = static_cast<unsigned>(numCells_);
+        for (unsigned i = 0; i < MaxDenseSamples; ++i)
+        {
+            const unsigned index = random.Next(numCells);
+            if (!(occupiedBits_[index / BitsPerWord] & (1u << (index % BitsPerWord))))
+                return UnflattenIndex(index);
+        }
+
+        // Pick k-th free cell otherwise, skipping whole groups by their counts
+        unsigned freeCellIndex = random.Next(static_cast<unsigned>(Size()));
+        unsigned groupIndex = 0;
+        while (freeCellIndex >= groupFreeCounts_[groupIndex])
+            freeCellIndex -= groupFreeCounts_[groupIndex++];
+
+        for (unsigned wordIndex = groupIndex * WordsPerGroup; wordIndex < occupiedBits_.size(); ++wordIndex)
+        {
+            unsigned freeBits = ~occupiedBits_[wordIndex];
+            const unsigned numFreeBits = CountSetBits(freeBits);
+            if (freeCellIndex >= numFreeBits)
+            {
+                freeCellIndex -= numFreeBits;
+                continue;
+            }
+
+            for (; freeCellIndex > 0; --freeCellIndex)
+                freeBits &= freeBits - 1;
+            const unsigned bit = CountSetBits((freeBits & (~freeBits + 1)) - 1);
+            return UnflattenIndex(wordIndex * BitsPerWord + bit);
+        }
+
+        assert(0);
+        return {};
+    }
+
+    IntVector4 GetRandomSparseCell(RandomGenerator& random) const
+    {
+        // Large boards are almost never full, so rejection sampling is the only practical option
+        for (unsigned i = 0; i < MaxSparseSamples; ++i)
+        {
+            const IntVector4 position = RandomIntVector4(random, gridSize_);
+            if (!occupiedCells_.Get(position))
+                return position;
+        }
+
+        // Crowded board, take the first free cell after random one.
+        // Every skipped cell is occupied, so it is O(number of occupied cells) at worst.
+        IntVector4 position = RandomIntVector4(random, gridSize_);
+        while (occupiedCells_.Get(position))
+            position = GetNextCell(position);
+        return position;
+    }
+
+    /// Return next cell in row-major order, last cell is followed by the first one.
+    IntVector4 GetNextCell(IntVector4 position) const
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            if (++position[i] < gridSize_)
+                break;
+            position[i] = 0;
+        }
+        return position;
+    }
+
+    /// Index of the cell of small board, it fits into 32 bits.
+    unsigned FlattenIndex(const IntVector4& pos) const
+    {
+        assert(!sparse_);
+        return static_cast<unsigned>(FlattenGridIndex(pos, gridSize_));
+    }
+
+    IntVector4 UnflattenIndex(unsigned index) const
+    {
+        const auto size = static_cast<unsigned>(gridSize_);
+        IntVector4 pos;
+        for (int i = 0; i < 4; ++i)
+        {
+            pos[i] = static_cast<int>(index % size);
+            index /= size;
+        }
+        return pos;
+    }
+
+    int gridSize_{};
+    bool sparse_{};
+    unsigned long long numCells_{};
+    unsigned long long numOccupiedCells_{};
+
+    /// Occupied cells of large boards.
+    GridChunkedArray4D<unsigned char> occupiedCells_;
+
+    /// Bitset of occupied cells of small boards.
+    ea::vector<unsigned> occupiedBits_;
+    /// Number of free cells in each group of words of the bitset.
+    ea::vector<unsigned> groupFreeCounts_;
+
+    /// Scratch list of excluded cells temporarily removed from the set.
+    ea::vector<IntVector4> excludedCells_;
+};
+
+}
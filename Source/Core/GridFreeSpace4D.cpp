@@ -0,0 +1,277 @@
+#include "GridFreeSpace4D.h"
+
+namespace Urho3D
+{
+
+GridFreeSpace4D::GridFreeSpace4D(int gridSize)
+    : gridSize_(gridSize)
+{
+    const auto size = static_cast<unsigned>(gridSize_);
+    strides_[0] = 1;
+    for (int i = 1; i < 4; ++i)
+        strides_[i] = strides_[i - 1] * size;
+
+    const unsigned numCells = size * size * size * size;
+    labels_.resize(numCells, OccupiedLabel);
+    visitMarks_.resize(numCells);
+}
+
+void GridFreeSpace4D::Occupy(const IntVector4& position)
+{
+    if (!valid_)
+        return;
+
+    const unsigned index = FlattenIndex(position);
+    const unsigned label = labels_[index];
+    if (label == OccupiedLabel)
+        return;
+
+    labels_[index] = OccupiedLabel;
+    if (--componentSizes_[label] == 0)
+        ReleaseLabel(label);
+    else
+        SplitComponent(index, label);
+}
+
+void GridFreeSpace4D::Free(const IntVector4& position)
+{
+    if (!valid_)
+        return;
+
+    const unsigned index = FlattenIndex(position);
+    if (labels_[index] != OccupiedLabel)
+        return;
+
+    // Find the largest adjacent component
+    unsigned bestLabel = OccupiedLabel;
+    for (unsigned i = 0; i < NumGridDirections; ++i)
+    {
+        const unsigned neighbor = GetNeighbor(index, static_cast<GridDirection4D>(i));
+        if (!IsFree(neighbor))
+            continue;
+
+        const unsigned label = labels_[neighbor];
+        if (bestLabel == OccupiedLabel || componentSizes_[label] > componentSizes_[bestLabel])
+            bestLabel = label;
+    }
+
+    if (bestLabel == OccupiedLabel)
+    {
+        labels_[index] = AllocateLabel(1);
+        return;
+    }
+
+    labels_[index] = bestLabel;
+    ++componentSizes_[bestLabel];
+
+    // Merge other adjacent components
+    for (unsigned i = 0; i < NumGridDirections; ++i)
+    {
+        const unsigned neighbor = GetNeighbor(index, static_cast<GridDirection4D>(i));
+        if (!IsFree(neighbor) || labels_[neighbor] == bestLabel)
+            continue;
+
+        const unsigned label = labels_[neighbor];
+        componentSizes_[bestLabel] += Relabel(neighbor, bestLabel);
+        ReleaseLabel(label);
+    }
+}
+
+unsigned GridFreeSpace4D::AllocateLabel(unsigned size)
+{
+    if (unusedLabels_.empty())
+    {
+        componentSizes_.push_back(size);
+        return componentSizes_.size() - 1;
+    }
+
+    const unsigned label = unusedLabels_.back();
+    unusedLabels_.pop_back();
+    componentSizes_[label] = size;
+    return label;
+}
+
+void GridFreeSpace4D::ReleaseLabel(unsigned label)
+{
+    componentSizes_[label] = 0;
+    unusedLabels_.push_back(label);
+}
+
+unsigned GridFreeSpace4D::Relabel(unsigned index, unsigned newLabel)
+{
+    const unsigned oldLabel = labels_[index];
+    assert(oldLabel != newLabel && oldLabel != OccupiedLabel);
+
+    relabelQueue_.clear();
+    relabelQueue_.push_back(index);
+    labels_[index] = newLabel;
+    for (unsigned head = 0; head < relabelQueue_.size(); ++head)
+    {
+        const unsigned current = relabelQueue_[head];
+        for (unsigned i = 0; i < NumGridDirections; ++i)
+        {
+            const unsigned neighbor = GetNeighbor(current, static_cast<GridDirection4D>(i));
+            if (neighbor != InvalidIndex && labels_[neighbor] == oldLabel)
+            {
+                labels_[neighbor] = newLabel;
+                relabelQueue_.push_back(neighbor);
+            }
+        }
+    }
+    return relabelQueue_.size();
+}
+
+unsigned GridFreeSpace4D::FindFloodSet(unsigned flood)
+{
+    while (floods_[flood].parent_ != flood)
+        flood = floods_[flood].parent_;
+    return flood;
+}
+
+void GridFreeSpace4D::SplitComponent(unsigned index, unsigned label)
+{
+    unsigned neighbors[NumGridDirections];
+    GridDirection4D neighborDirections[NumGridDirections];
+    unsigned numNeighbors = 0;
+    for (unsigned i = 0; i < NumGridDirections; ++i)
+    {
+        const auto direction = static_cast<GridDirection4D>(i);
+        const unsigned neighbor = GetNeighbor(index, direction);
+        if (IsFree(neighbor))
+        {
+            neighbors[numNeighbors] = neighbor;
+            neighborDirections[numNeighbors] = direction;
+            ++numNeighbors;
+        }
+    }
+    if (numNeighbors <= 1)
+        return;
+
+    // Start flood fill from each neighbor. Neighbors connected through a free diagonal cell share a flood fill.
+    if (visitStamp_ > M_MAX_UNSIGNED - 2 * NumGridDirections)
+    {
+        ea::fill(visitMarks_.begin(), visitMarks_.end(), 0u);
+        visitStamp_ = 0;
+    }
+    const unsigned stampBase = ++visitStamp_;
+    visitStamp_ += NumGridDirections;
+
+    for (unsigned i = 0; i < numNeighbors; ++i)
+    {
+        FloodFill& flood = floods_[i];
+        flood.queue_.clear();
+        flood.head_ = 0;
+        flood.parent_ = i;
+    }
+
+    for (unsigned i = 0; i < numNeighbors; ++i)
+    {
+        for (unsigned j = i + 1; j < numNeighbors; ++j)
+        {
+            const bool sameAxis = GetDirectionAxis(neighborDirections[i]) == GetDirectionAxis(neighborDirections[j]);
+            if (!sameAxis && IsFree(GetNeighbor(neighbors[i], neighborDirections[j])))
+                floods_[FindFloodSet(j)].parent_ = FindFloodSet(i);
+        }
+    }
+
+    unsigned numSets = 0;
+    for (unsigned i = 0; i < numNeighbors; ++i)
+    {
+        const unsigned set = FindFloodSet(i);
+        numSets += set == i;
+        floods_[set].queue_.push_back(neighbors[i]);
+        visitMarks_[neighbors[i]] = stampBase + set;
+    }
+    if (numSets == 1)
+        return;
+
+    // Advance flood fills in turns until at most one set of met flood fills is still growing
+    while (true)
+    {
+        unsigned numGrowingSets = 0;
+        unsigned numDistinctSets = 0;
+        for (unsigned i = 0; i < numNeighbors; ++i)
+        {
+            if (FindFloodSet(i) != i)
+                continue;
+            ++numDistinctSets;
+
+            bool growing = false;
+            for (unsigned j = 0; j < numNeighbors; ++j)
+                growing = growing || (FindFloodSet(j) == i && !floods_[j].IsExhausted());
+            numGrowingSets += growing;
+        }
+
+        // Component is still connected
+        if (numDistinctSets == 1)
+            return;
+        if (numGrowingSets <= 1)
+            break;
+
+        for (unsigned i = 0; i < numNeighbors; ++i)
+        {
+            FloodFill& flood = floods_[i];
+            if (flood.IsExhausted())
+                continue;
+
+            const unsigned current = flood.queue_[flood.head_++];
+            for (unsigned j = 0; j < NumGridDirections; ++j)
+            {
+                const unsigned neighbor = GetNeighbor(current, static_cast<GridDirection4D>(j));
+                if (!IsFree(neighbor))
+                    continue;
+
+                const unsigned mark = visitMarks_[neighbor];
+                if (mark < stampBase || mark >= stampBase + NumGridDirections)
+                {
+                    visitMarks_[neighbor] = stampBase + i;
+                    flood.queue_.push_back(neighbor);
+                }
+                else
+                {
+                    const unsigned otherSet = FindFloodSet(mark - stampBase);
+                    const unsigned thisSet = FindFloodSet(i);
+                    if (otherSet != thisSet)
+                        floods_[otherSet].parent_ = thisSet;
+                }
+            }
+        }
+    }
+
+    // Fully explored sets become new components, the largest one keeps the label if all sets are explored
+    unsigned setSizes[NumGridDirections]{};
+    bool setGrowing[NumGridDirections]{};
+    unsigned keptSet = M_MAX_UNSIGNED;
+    for (unsigned i = 0; i < numNeighbors; ++i)
+    {
+        const unsigned set = FindFloodSet(i);
+        setSizes[set] += floods_[i].queue_.size();
+        setGrowing[set] = setGrowing[set] || !floods_[i].IsExhausted();
+    }
+    for (unsigned i = 0; i < numNeighbors; ++i)
+    {
+        if (FindFloodSet(i) != i)
+            continue;
+        if (keptSet == M_MAX_UNSIGNED || setGrowing[i] || (!setGrowing[keptSet] && setSizes[i] > setSizes[keptSet]))
+            keptSet = i;
+    }
+
+    for (unsigned i = 0; i < numNeighbors; ++i)
+    {
+        const unsigned set = FindFloodSet(i);
+        if (set != i || set == keptSet)
+            continue;
+
+        const unsigned newLabel = AllocateLabel(setSizes[set]);
+        componentSizes_[label] -= setSizes[set];
+        for (unsigned j = 0; j < numNeighbors; ++j)
+        {
+            if (FindFloodSet(j) != set)
+                continue;
+            for (unsigned cell : floods_[j].queue_)
+                labels_[cell] = newLabel;
+        }
+    }
+}
+
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "Math4D.h"
+#include "GridRotation4D.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Connected components of free grid cells with their sizes, updated incrementally as cells are occupied and freed.
+/// Freeing a cell merges adjacent components by relabeling the smaller ones.
+/// Occupying a cell detects split by simultaneous flood fills from its neighbors,
+/// which stop as soon as all parts but one are fully explored.
+class GridFreeSpace4D
+{
+public:
+    static constexpr unsigned OccupiedLabel = M_MAX_UNSIGNED;
+
+    explicit GridFreeSpace4D(int gridSize = 0);
+
+    /// Rebuild components from scratch. Cell is free if callback returns true for its position.
+    template <class T>
+    void Rebuild(const T& isFree);
+
+    /// Mark components as outdated. Incremental updates are ignored until rebuild.
+    void Invalidate() { valid_ = false; }
+
+    /// Set whether cells on opposite board edges are adjacent. Components are invalidated.
+    void SetWrapAround(bool wrapAround)
+    {
+        wrapAround_ = wrapAround;
+        Invalidate();
+    }
+
+    bool IsValid() const { return valid_; }
+
+    /// Mark cell as occupied, do nothing if it is occupied already.
+    void Occupy(const IntVector4& position);
+
+    /// Mark cell as free, do nothing if it is free already.
+    void Free(const IntVector4& position);
+
+    /// Return number of free cells in the component of the cell, zero if the cell is occupied.
+    unsigned GetComponentSize(const IntVector4& position) const
+    {
+        const unsigned label = labels_[FlattenIndex(position)];
+        return label != OccupiedLabel ? componentSizes_[label] : 0;
+    }
+
+private:
+    static constexpr unsigned InvalidIndex = M_MAX_UNSIGNED;
+    /// Temporary label of free cells during rebuild.
+    static constexpr unsigned UnlabeledFree = M_MAX_UNSIGNED - 1;
+
+    struct FloodFill
+    {
+        ea::vector<unsigned> queue_;
+        unsigned head_{};
+        /// Flood fills that met each other are merged into one set.
+        unsigned parent_{};
+
+        bool IsExhausted() const { return head_ == queue_.size(); }
+    };
+
+    unsigned FlattenIndex(const IntVector4& pos) const
+    {
+        return static_cast<unsigned>(((pos[3] * gridSize_ + pos[2]) * gridSize_ + pos[1]) * gridSize_ + pos[0]);
+    }
+
+    /// Return index of adjacent cell in given direction, InvalidIndex if outside.
+    unsigned GetNeighbor(unsigned index, GridDirection4D direction) const
+    {
+        const unsigned stride = strides_[GetDirectionAxis(direction)];
+        const unsigned coordinate = index / stride % static_cast<unsigned>(gridSize_);
+        const unsigned edgeStride = stride * static_cast<unsigned>(gridSize_ - 1);
+        if (GetDirectionSign(direction) > 0)
+        {
+            if (coordinate + 1 < static_cast<unsigned>(gridSize_))
+                return index + stride;
+            return wrapAround_ ? index - edgeStride : InvalidIndex;
+        }
+        else
+        {
+            if (coordinate > 0)
+                return index - stride;
+            return wrapAround_ ? index + edgeStride : InvalidIndex;
+        }
+    }
+
+    bool IsFree(unsigned index) const { return index != InvalidIndex && labels_[index] != OccupiedLabel; }
+
+    unsigned AllocateLabel(unsigned size);
+    void ReleaseLabel(unsigned label);
+    /// Replace label of all cells in the component starting from given cell, return number of cells.
+    unsigned Relabel(unsigned index, unsigned newLabel);
+    /// Split component after removal of the cell if needed.
+    void SplitComponent(unsigned index, unsigned label);
+    unsigned FindFloodSet(unsigned flood);
+
+    int gridSize_{};
+    unsigned strides_[4]{};
+    bool wrapAround_{};
+    bool valid_{};
+
+    /// Component label of each cell, OccupiedLabel for occupied cells.
+    ea::vector<unsigned> labels_;
+    ea::vector<unsigned> componentSizes_;
+    ea::vector<unsigned> unusedLabels_;
+
+    /// Flood fill scratch data.
+    ea::vector<unsigned> visitMarks_;
+    unsigned visitStamp_{};
+    ea::vector<unsigned> relabelQueue_;
+    FloodFill floods_[NumGridDirections];
+};
+
+template <class T>
+void GridFreeSpace4D::Rebuild(const T& isFree)
+{
+    const unsigned numCells = labels_.size();
+    IntVector4 position{};
+    for (unsigned index = 0; index < numCells; ++index)
+    {
+        labels_[index] = isFree(position) ? UnlabeledFree : OccupiedLabel;
+
+        // Advance position in flattened order
+        for (int i = 0; i < 4 && ++position[i] == gridSize_; ++i)
+            position[i] = 0;
+    }
+
+    componentSizes_.clear();
+    unusedLabels_.clear();
+    for (unsigned index = 0; index < numCells; ++index)
+    {
+        if (labels_[index] == UnlabeledFree)
+        {
+            const unsigned label = AllocateLabel(0);
+            componentSizes_[label] = Relabel(index, label);
+        }
+    }
+    valid_ = true;
+}
+
+}
@@ -0,0 +1,178 @@
+#include "GridHamiltonianCycle4D.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Return Hamiltonian cycle over square grid. Corner cell (0, 0) is skipped if size is odd.
+ea::vector<IntVector2> BuildSquareCycle(int size)
+{
+    ea::vector<IntVector2> cycle;
+    if (size % 2 == 0)
+    {
+        // Snake through columns 1+ row by row, return along column 0
+        for (int y = 0; y < size; ++y)
+        {
+            for (int i = 1; i < size; ++i)
+                cycle.emplace_back(y % 2 == 0 ? i : size - i, y);
+        }
+        for (int y = size - 1; y >= 0; --y)
+            cycle.emplace_back(0, y);
+    }
+    else
+    {
+        // Zigzag through rows 0 and 1, snake through columns 1+ of other rows, return along column 0.
+        // Cells around the corner go in order (1, 0), (1, 1), (0, 1), in reverse.
+        cycle.emplace_back(0, 1);
+        for (int x = 1; x < size; ++x)
+        {
+            cycle.emplace_back(x, x % 2 == 0 ? 0 : 1);
+            cycle.emplace_back(x, x % 2 == 0 ? 1 : 0);
+        }
+        for (int y = 2; y < size; ++y)
+        {
+            for (int i = 1; i < size; ++i)
+                cycle.emplace_back(y % 2 == 0 ? size - i : i, y);
+        }
+        for (int y = size - 1; y >= 2; --y)
+            cycle.emplace_back(0, y);
+    }
+    return cycle;
+}
+
+/// Return Hamiltonian path over square grid starting at (0, 0).
+ea::vector<IntVector2> BuildSquarePath(int size)
+{
+    ea::vector<IntVector2> path;
+    for (int y = 0; y < size; ++y)
+    {
+        for (int i = 0; i < size; ++i)
+            path.emplace_back(y % 2 == 0 ? i : size - 1 - i, y);
+    }
+    return path;
+}
+
+IntVector4 MakeCell(const IntVector2& xy, const IntVector2& zw)
+{
+    return { xy.x_, xy.y_, zw.x_, zw.y_ };
+}
+
+/// Return Hamiltonian cycle over product of square cycle of even length and square path.
+ea::vector<IntVector4> BuildProductCycle(const ea::vector<IntVector2>& cycle, const ea::vector<IntVector2>& path)
+{
+    // First cycle cell goes through all path cells, other cycle cells snake through path cells 1+
+    // and return along path cell 0
+    ea::vector<IntVector4> result;
+    for (unsigned j = 0; j < path.size(); ++j)
+        result.push_back(MakeCell(cycle[0], path[j]));
+    for (unsigned i = 1; i < cycle.size(); ++i)
+    {
+        for (unsigned j = 1; j < path.size(); ++j)
+            result.push_back(MakeCell(cycle[i], path[i % 2 == 0 ? j : path.size() - j]));
+    }
+    for (unsigned i = cycle.size() - 1; i >= 1; --i)
+        result.push_back(MakeCell(cycle[i], path[0]));
+    return result;
+}
+
+bool AreAdjacent(const IntVector4& lhs, const IntVector4& rhs)
+{
+    int distance = 0;
+    for (int i = 0; i < 4; ++i)
+        distance += Abs(lhs[i] - rhs[i]);
+    return distance == 1;
+}
+
+}
+
+GridHamiltonianCycle4D::GridHamiltonianCycle4D(int size)
+    : size_(size)
+    , hasHole_(size % 2 != 0)
+{
+    assert(size >= 2);
+
+    const unsigned numCells = static_cast<unsigned>(size_ * size_ * size_ * size_);
+    order_.resize(numCells);
+    nextDirections_.resize(numCells);
+
+    // Cover (X, Y) plane without hole times whole (Z, W) plane
+    const ea::vector<IntVector2> squareCycle = BuildSquareCycle(size_);
+    ea::vector<IntVector4> cycle = BuildProductCycle(squareCycle, BuildSquarePath(size_));
+    for (unsigned i = 0; i < cycle.size(); ++i)
+        order_[FlattenIndex(cycle[i])] = i;
+
+    if (hasHole_)
+    {
+        // Cover (Z, W) plane at the hole separately and merge cycles through adjacent edges.
+        // Edges near the hole are kept intact.
+        ea::vector<IntVector4> holeCycle;
+        for (const IntVector2& zw : squareCycle)
+            holeCycle.push_back(MakeCell(IntVector2{ 0, 0 }, zw));
+
+        const unsigned holeCycleLength = holeCycle.size();
+        const unsigned cycleLength = cycle.size();
+        const IntVector4 shift{ 0, 1, 0, 0 };
+        for (unsigned i = 2; i < holeCycleLength; ++i)
+        {
+            const IntVector4& first = holeCycle[i];
+            const IntVector4& second = holeCycle[(i + 1) % holeCycleLength];
+            const unsigned firstOrder = order_[FlattenIndex(first + shift)];
+            const unsigned secondOrder = order_[FlattenIndex(second + shift)];
+
+            ea::vector<IntVector4> insertion;
+            unsigned insertAfter{};
+            if ((firstOrder + 1) % cycleLength == secondOrder)
+            {
+                for (unsigned j = 0; j < holeCycleLength; ++j)
+                    insertion.push_back(holeCycle[(i + holeCycleLength - j) % holeCycleLength]);
+                insertAfter = firstOrder;
+            }
+            else if ((secondOrder + 1) % cycleLength == firstOrder)
+            {
+                for (unsigned j = 0; j < holeCycleLength; ++j)
+                    insertion.push_back(holeCycle[(i + 1 + j) % holeCycleLength]);
+                insertAfter = secondOrder;
+            }
+            else
+                continue;
+
+            cycle.insert(cycle.begin() + insertAfter + 1, insertion.begin(), insertion.end());
+            break;
+        }
+        assert(cycle.size() + 1 == numCells);
+
+        for (unsigned i = 0; i < cycle.size(); ++i)
+            order_[FlattenIndex(cycle[i])] = i;
+    }
+
+    length_ = cycle.size();
+    for (unsigned i = 0; i < length_; ++i)
+    {
+        const IntVector4& next = cycle[(i + 1) % length_];
+        assert(AreAdjacent(cycle[i], next));
+        nextDirections_[FlattenIndex(cycle[i])] = IntVectorToDirection(next - cycle[i]);
+    }
+
+    if (hasHole_)
+    {
+        // Find cell whose cycle neighbors are both adjacent to the hole
+        for (unsigned i = 0; i < length_; ++i)
+        {
+            const IntVector4& prev = cycle[(i + length_ - 1) % length_];
+            const IntVector4& next = cycle[(i + 1) % length_];
+            if (AreAdjacent(prev, hole_) && AreAdjacent(next, hole_))
+            {
+                bypass_ = cycle[i];
+                break;
+            }
+        }
+        assert(bypass_ != hole_);
+
+        order_[FlattenIndex(hole_)] = GetOrder(bypass_);
+        nextDirections_[FlattenIndex(hole_)] = IntVectorToDirection(GetNext(bypass_) - hole_);
+    }
+}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Math4D.h"
+#include "GridRotation4D.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Hamiltonian cycle over 4D grid, stored as direction to the next cell and order index of each cell.
+/// Grid of odd size has odd number of cells and cannot be covered by a cycle, so the corner cell
+/// (0, 0, 0, 0) is left out. This hole may be visited instead of the bypass cell:
+/// the hole is adjacent to both neighbors of the bypass cell on the cycle and shares its order index.
+class GridHamiltonianCycle4D
+{
+public:
+    explicit GridHamiltonianCycle4D(int size);
+
+    int GetSize() const { return size_; }
+
+    /// Return number of cells on the cycle.
+    unsigned GetLength() const { return length_; }
+
+    unsigned GetOrder(const IntVector4& position) const { return order_[FlattenIndex(position)]; }
+
+    IntVector4 GetNext(const IntVector4& position) const
+    {
+        return position + DirectionToIntVector(nextDirections_[FlattenIndex(position)]);
+    }
+
+    /// Return number of steps along the cycle from one cell to another.
+    unsigned GetDistance(const IntVector4& from, const IntVector4& to) const
+    {
+        return (GetOrder(to) + length_ - GetOrder(from)) % length_;
+    }
+
+    bool HasHole() const { return hasHole_; }
+
+    const IntVector4& GetHole() const { return hole_; }
+
+    const IntVector4& GetBypass() const { return bypass_; }
+
+private:
+    unsigned FlattenIndex(const IntVector4& pos) const
+    {
+        return static_cast<unsigned>(((pos[3] * size_ + pos[2]) * size_ + pos[1]) * size_ + pos[0]);
+    }
+
+    int size_{};
+    unsigned length_{};
+    bool hasHole_{};
+    IntVector4 hole_{};
+    IntVector4 bypass_{};
+
+    ea::vector<unsigned> order_;
+    ea::vector<GridDirection4D> nextDirections_;
+};
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Math4D.h"
+
+#include <EASTL/span.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Urho3D
+{
+
+/// Static obstacle cells of the board viewed in place as bitset of flattened cell indices.
+/// The set does not own the bits, so it may point into memory-mapped level pack. Empty set has no bits.
+class GridObstacleSet4D
+{
+public:
+    static const unsigned BitsPerWord = 64;
+    /// Max board size such that flattened cell indices fit into 32 bits.
+    static const int MaxGridSize = 255;
+
+    GridObstacleSet4D() = default;
+
+    /// Bits must hold GetNumWords(gridSize) words and outlive the set.
+    GridObstacleSet4D(int gridSize, const unsigned long long* words)
+        : gridSize_(gridSize)
+        , words_(words)
+    {
+        assert(gridSize_ <= MaxGridSize);
+    }
+
+    /// Return number of 64-bit words in the bitset of the board.
+    static unsigned GetNumWords(int gridSize)
+    {
+        const auto size = static_cast<unsigned>(gridSize);
+        return (size * size * size * size + BitsPerWord - 1) / BitsPerWord;
+    }
+
+    bool IsEmpty() const { return words_ == nullptr; }
+
+    /// Return whether the cell on the board is an obstacle.
+    bool Contains(const IntVector4& position) const
+    {
+        if (!words_)
+            return false;
+
+        const unsigned index = FlattenIndex(position);
+        return (words_[index / BitsPerWord] >> (index % BitsPerWord)) & 1;
+    }
+
+    /// Call function for each obstacle cell in index order.
+    template <class T>
+    void ForEach(const T& callback) const
+    {
+        if (!words_)
+            return;
+
+        const unsigned numWords = GetNumWords(gridSize_);
+        for (unsigned wordIndex = 0; wordIndex < numWords; ++wordIndex)
+        {
+            // Visit set bits only, obstacles are usually sparse
+            unsigned long long word = words_[wordIndex];
+            while (word != 0)
+            {
+                const unsigned bit = CountTrailingZeros(word);
+                callback(UnflattenIndex(wordIndex * BitsPerWord + bit));
+                word &= word - 1;
+            }
+        }
+    }
+
+    int GetGridSize() const { return gridSize_; }
+
+    ea::span<const unsigned long long> GetWords() const
+    {
+        return { words_, words_ ? GetNumWords(gridSize_) : 0u };
+    }
+
+private:
+    /// Value must not be zero.
+    static unsigned CountTrailingZeros(unsigned long long value)
+    {
+        assert(value != 0);
+#if defined(_MSC_VER) && defined(_WIN64)
+        unsigned long result = 0;
+        _BitScanForward64(&result, value);
+        return static_cast<unsigned>(result);
+#elif defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+        // Isolate the lowest set bit and count bits below it
+        const unsigned long long lowBits = (value & (~value + 1)) - 1;
+        return CountSetBits(static_cast<unsigned>(lowBits)) + CountSetBits(static_cast<unsigned>(lowBits >> 32));
+#endif
+    }
+
+    unsigned FlattenIndex(const IntVector4& pos) const
+    {
+        const auto size = static_cast<unsigned>(gridSize_);
+        return ((static_cast<unsigned>(pos[3]) * size + pos[2]) * size + pos[1]) * size + pos[0];
+    }
+
+    IntVector4 UnflattenIndex(unsigned index) const
+    {
+        const auto size = static_cast<unsigned>(gridSize_);
+        IntVector4 pos;
+        for (int i = 0; i < 4; ++i)
+        {
+            pos[i] = static_cast<int>(index % size);
+            index /= size;
+        }
+        return pos;
+    }
+
+    int gridSize_{};
+    const unsigned long long* words_{};
+};
+
+}
@@ -1,12 +1,17 @@
 #pragma once
 
 #include "Math4D.h"
+#include "GridChunkedArray4D.h"
+#include "GridTopology4D.h"
 
 #include <EASTL/priority_queue.h>
 
 namespace Urho3D
 {
 
+/// A* path finder for snake head that prefers fewer turns.
+/// Search state is stored in sparse bricks allocated on touch,
+/// so memory depends on the explored area rather than on the board size.
 class GridPathFinder4D
 {
     static const unsigned PreStartElement = 0;
@@ -19,17 +24,40 @@ public:
         : gridSize_(gridSize)
         , movementCost_(movementCost)
         , rotationCost_(rotationCost)
+        , topology_(gridSize)
     {
     }
 
+    /// Set topology of the board of the same size. Cached path is discarded.
+    void SetTopology(const GridTopology4D& topology)
+    {
+        assert(topology.GetSize() == gridSize_);
+        topology_ = topology;
+        path_.clear();
+    }
+
     template <class T>
     bool UpdatePath(const IntVector4& startPosition, const IntVector4& startDirection,
-        const IntVector4& targetPosition, const T& checkCell);
+        const IntVector4& targetPosition, const T& checkCell)
+    {
+        const auto findNearestTarget = [&](const IntVector4&) { return targetPosition; };
+        return UpdatePathToNearest(startPosition, startDirection, findNearestTarget, checkCell);
+    }
+
+    /// Find path to any of many targets in one search.
+    /// Callback returns the target nearest to given position, which drives heuristic.
+    /// Cell is reached target if it is the nearest target to itself.
+    template <class T, class U>
+    bool UpdatePathToNearest(const IntVector4& startPosition, const IntVector4& startDirection,
+        const U& findNearestTarget, const T& checkCell);
+
+    /// Forget cached path, e.g. when the board was changed externally.
+    void ClearPath() { path_.clear(); }
 
     IntVector4 GetNextCellOffset() const
     {
         return path_.size() >= MinElements
-            ? path_[NextElement] - path_[StartElement]
+            ? topology_.GetDelta(path_[StartElement], path_[NextElement])
             : IntVector4{};
     }
 
@@ -41,6 +69,13 @@ public:
     }
 
 private:
+    struct SearchNode
+    {
+        IntVector4 cameFrom_{};
+        int gScore_{ M_MAX_INT };
+        int fScore_{ M_MAX_INT };
+    };
+
     struct OpenSetNode
     {
         IntVector4 position;
@@ -49,16 +84,11 @@ private:
 
     friend bool operator < (const OpenSetNode& lhs, const OpenSetNode& rhs) { return lhs.fScore > rhs.fScore; }
 
-    unsigned FlattenIndex(const IntVector4& pos) const
-    {
-        return static_cast<unsigned>(((pos[3] * gridSize_ + pos[2]) * gridSize_ + pos[1]) * gridSize_ + pos[0]);
-    }
-
     int EstimateWeightToFinish(const IntVector4& prevPosition, const IntVector4& currentPosition,
         const IntVector4& targetPosition) const
     {
-        const IntVector4 currentDirection = currentPosition - prevPosition;
-        const IntVector4 targetDelta = targetPosition - currentPosition;
+        const IntVector4 currentDirection = topology_.GetDelta(prevPosition, currentPosition);
+        const IntVector4 targetDelta = topology_.GetDelta(currentPosition, targetPosition);
         const int projectionDistance = DotProduct(targetDelta, currentDirection);
         const IntVector4 projectedTargetDelta = targetDelta - projectionDistance * currentDirection;
 
@@ -78,7 +108,7 @@ private:
     int CalculateMovementWeight(const IntVector4& prevPosition, const IntVector4& currentPosition,
         const IntVector4& offset) const
     {
-        const IntVector4 currentDirection = currentPosition - prevPosition;
+        const IntVector4 currentDirection = topology_.GetDelta(prevPosition, currentPosition);
         const int projectionDistance = DotProduct(offset, currentDirection);
 
         if (projectionDistance > 0)
@@ -89,23 +119,20 @@ private:
             return 2 * rotationCost_; // 2 rotations
     }
 
-    void AddToOpenSet(const IntVector4& position)
+    void AddToOpenSet(const IntVector4& position, int fScore)
     {
-        const unsigned index = FlattenIndex(position);
-
-        const bool found = false;
         for (unsigned i = 0; i < openSet_.size(); ++i)
         {
             auto& node = openSet_.get_container()[i];
             if (node.position == position)
             {
-                node.fScore = fScore_[index];
+                node.fScore = fScore;
                 openSet_.change(i);
                 return;
             }
         }
 
-        openSet_.push({ position, fScore_[index] });
+        openSet_.push({ position, fScore });
     }
 
     void ReconstructPath(const IntVector4& startPosition, const IntVector4& targetPosition)
@@ -114,12 +141,12 @@ private:
         while (pathElement != startPosition)
         {
             path_.push_back(pathElement);
-            pathElement = cameFrom_[FlattenIndex(pathElement)];
+            pathElement = nodes_.Get(pathElement).cameFrom_;
         }
 
         // Add start and pre-start position for caching
         path_.push_back(startPosition);
-        path_.push_back(cameFrom_[FlattenIndex(startPosition)]);
+        path_.push_back(nodes_.Get(startPosition).cameFrom_);
 
         ea::reverse(path_.begin(), path_.end());
     }
@@ -127,26 +154,25 @@ private:
     int gridSize_{};
     int movementCost_{};
     int rotationCost_{};
+    GridTopology4D topology_;
 
     ea::priority_queue<OpenSetNode> openSet_;
-    ea::vector<IntVector4> cameFrom_;
-    ea::vector<int> gScore_;
-    ea::vector<int> fScore_;
+    GridChunkedArray4D<SearchNode> nodes_;
 
     ea::vector<IntVector4> path_;
 };
 
-template <class T>
-bool GridPathFinder4D::UpdatePath(const IntVector4& startPosition, const IntVector4& startDirection,
-    const IntVector4& targetPosition, const T& checkCell)
+template <class T, class U>
+bool GridPathFinder4D::UpdatePathToNearest(const IntVector4& startPosition, const IntVector4& startDirection,
+    const U& findNearestTarget, const T& checkCell)
 {
-    // Try to reuse previously calculated path
-    if (path_.size() >= MinElements && path_.back() == targetPosition)
+    // Try to reuse previously calculated path if it still leads to a target
+    if (path_.size() >= MinElements && findNearestTarget(path_.back()) == path_.back())
     {
         for (unsigned i = StartElement; i < path_.size(); ++i)
         {
             const IntVector4 cachedPosition = path_[i];
-            const IntVector4 cachedDirection = path_[i] - path_[i - 1];
+            const IntVector4 cachedDirection = topology_.GetDelta(path_[i - 1], path_[i]);
             if (cachedPosition == startPosition && cachedDirection == startDirection)
             {
                 // Erase outdated elements
@@ -159,20 +185,14 @@ bool GridPathFinder4D::UpdatePath(const IntVector4& startPosition, const IntVect
     // Rebuild path from scratch
     path_.clear();
     openSet_.get_container().clear();
-    gScore_.clear();
-    fScore_.clear();
+    nodes_.Clear();
 
-    const auto capacity = static_cast<unsigned>(gridSize_ * gridSize_ * gridSize_ * gridSize_);
-    cameFrom_.resize(capacity);
-    gScore_.resize(capacity, M_MAX_INT);
-    fScore_.resize(capacity, M_MAX_INT);
+    SearchNode& startNode = nodes_.GetOrCreate(startPosition);
+    startNode.cameFrom_ = topology_.Step(startPosition, -1 * startDirection);
+    startNode.gScore_ = 0;
+    startNode.fScore_ = EstimateWeightToFinish(startNode.cameFrom_, startPosition, findNearestTarget(startPosition));
 
-    const unsigned startIndex = FlattenIndex(startPosition);
-    cameFrom_[startIndex] = startPosition - startDirection;
-    gScore_[startIndex] = 0;
-    fScore_[startIndex] = EstimateWeightToFinish(cameFrom_[startIndex], startPosition, targetPosition);
-
-    AddToOpenSet(startPosition);
+    AddToOpenSet(startPosition, startNode.fScore_);
 
     // Size of the open set changes!
     while (!openSet_.empty())
@@ -181,15 +201,17 @@ bool GridPathFinder4D::UpdatePath(const IntVector4& startPosition, const IntVect
         openSet_.pop();
 
         const IntVector4& currentPosition = currentNode.position;
-        const unsigned currentIndex = FlattenIndex(currentPosition);
 
         // Path is found, reconstruct and exit
-        if (currentPosition == targetPosition)
+        if (findNearestTarget(currentPosition) == currentPosition)
         {
-            ReconstructPath(startPosition, targetPosition);
+            ReconstructPath(startPosition, currentPosition);
             return true;
         }
 
+        // Copy node data, allocation of new bricks may invalidate references
+        const SearchNode current = nodes_.Get(currentPosition);
+
         // For each neighbor
         for (unsigned i = 0; i < 8; ++i)
         {
@@ -197,21 +219,20 @@ bool GridPathFinder4D::UpdatePath(const IntVector4& startPosition, const IntVect
             offset[i / 2] = !!(i % 2) ? 1 : -1;
 
             // Skip if cannot go there
-            const IntVector4 neighborPosition = currentPosition + offset;
-            const unsigned neighborIndex = FlattenIndex(neighborPosition);
+            const IntVector4 neighborPosition = topology_.Step(currentPosition, offset);
             if (!checkCell(neighborPosition))
                 continue;
 
-            const IntVector4 prevPosition = cameFrom_[FlattenIndex(currentPosition)];
-            const int movementWeight = CalculateMovementWeight(prevPosition, currentPosition, offset);
-            const int gScoreNew = gScore_[currentIndex] + movementWeight;
-            if (gScoreNew < gScore_[neighborIndex])
+            const int movementWeight = CalculateMovementWeight(current.cameFrom_, currentPosition, offset);
+            const int gScoreNew = current.gScore_ + movementWeight;
+            if (gScoreNew < nodes_.Get(neighborPosition).gScore_)
             {
-                const int weightToFinish = EstimateWeightToFinish(currentPosition, neighborPosition, targetPosition);
-                cameFrom_[neighborIndex] = currentPosition;
-                gScore_[neighborIndex] = gScoreNew;
-                fScore_[neighborIndex] = gScore_[neighborIndex] + weightToFinish;
-                AddToOpenSet(neighborPosition);
+                const int weightToFinish = EstimateWeightToFinish(currentPosition, neighborPosition, findNearestTarget(neighborPosition));
+                SearchNode& neighbor = nodes_.GetOrCreate(neighborPosition);
+                neighbor.cameFrom_ = currentPosition;
+                neighbor.gScore_ = gScoreNew;
+                neighbor.fScore_ = gScoreNew + weightToFinish;
+                AddToOpenSet(neighborPosition, neighbor.fScore_);
             }
         }
     }
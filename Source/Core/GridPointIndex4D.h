@@ -0,0 +1,249 @@
+#pragma once
+
+#include "Math4D.h"
+#include "GridChunkedArray4D.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Set of distinct grid cells bucketed into uniform 4D bins for nearest cell queries.
+/// Nearest cell is searched in rings of bins around the query, so query cost depends on the distance
+/// to the nearest cell rather than on the number of cells. Few cells on large boards are scanned directly.
+/// Query results are cached per cell until the set is modified, so queries are not thread safe.
+class GridPointIndex4D
+{
+public:
+    /// Zero bin size is chosen automatically to keep the number of bins bounded on large boards.
+    explicit GridPointIndex4D(int gridSize = 0, int binSize = 0)
+    {
+        Reset(gridSize, binSize);
+    }
+
+    /// Remove all cells.
+    void Reset(int gridSize, int binSize = 0)
+    {
+        gridSize_ = gridSize;
+        binSize_ = binSize > 0 ? binSize : ea::max(DefaultBinSize, (gridSize_ + MaxAutoBins - 1) / MaxAutoBins);
+        numBins_ = (gridSize_ + binSize_ - 1) / binSize_;
+
+        bins_.clear();
+        bins_.resize(static_cast<unsigned>(numBins_ * numBins_ * numBins_ * numBins_));
+        points_.clear();
+
+        nearestCache_.Reset();
+        version_ = 1;
+    }
+
+    /// Remove all cells. Only bins of the cells are visited, so it is O(number of cells).
+    void Clear()
+    {
+        for (const IntVector4& position : points_)
+            bins_[GetBinIndex(GetBin(position))].clear();
+        points_.clear();
+        InvalidateCache();
+    }
+
+    bool Contains(const IntVector4& position) const
+    {
+        const auto& bin = bins_[GetBinIndex(GetBin(position))];
+        return ea::find(bin.begin(), bin.end(), position) != bin.end();
+    }
+
+    void Insert(const IntVector4& position)
+    {
+        auto& bin = bins_[GetBinIndex(GetBin(position))];
+        if (ea::find(bin.begin(), bin.end(), position) != bin.end())
+            return;
+
+        bin.push_back(position);
+        points_.push_back(position);
+        InvalidateCache();
+    }
+
+    void Remove(const IntVector4& position)
+    {
+        auto& bin = bins_[GetBinIndex(GetBin(position))];
+        const auto iter = ea::find(bin.begin(), bin.end(), position);
+        if (iter == bin.end())
+            return;
+
+        *iter = bin.back();
+        bin.pop_back();
+
+        const auto pointIter = ea::find(points_.begin(), points_.end(), position);
+        *pointIter = points_.back();
+        points_.pop_back();
+        InvalidateCache();
+    }
+
+    bool IsEmpty() const { return points_.empty(); }
+
+    unsigned Size() const { return points_.size(); }
+
+    /// Return cell nearest to the position by Manhattan distance. Ties are broken by cell index.
+    /// Index must not be empty.
+    IntVector4 FindNearest(const IntVector4& position) const
+    {
+        assert(!points_.empty());
+
+        const IntVector4 gridBegin{ 0, 0, 0, 0 };
+        const IntVector4 gridEnd{ gridSize_, gridSize_, gridSize_, gridSize_ };
+        if (!IsInside(position, gridBegin, gridEnd))
+            return SearchNearest(position);
+
+        const CachedQuery& cachedQuery = nearestCache_.Get(position);
+        if (cachedQuery.version_ == version_)
+            return cachedQuery.nearest_;
+
+        const IntVector4 nearest = SearchNearest(position);
+        nearestCache_.Set(position, { nearest, version_ });
+        return nearest;
+    }
+
+private:
+    static constexpr int DefaultBinSize = 4;
+    /// Max number of bins along each axis if bin size is chosen automatically.
+    static constexpr int MaxAutoBins = 16;
+
+    struct CachedQuery
+    {
+        IntVector4 nearest_{};
+        /// Version of the set when the query was answered, zero if never.
+        unsigned version_{};
+    };
+
+    IntVector4 SearchNearest(const IntVector4& position) const
+    {
+        IntVector4 bestPosition{};
+        int bestDistance = M_MAX_INT;
+        unsigned long long bestIndex = ea::numeric_limits<unsigned long long>::max();
+        const auto updateBest = [&](const IntVector4& candidate)
+        {
+            const int distance = GetManhattanDistance(position, candidate);
+            const unsigned long long index = FlattenGridIndex(candidate, gridSize_);
+            if (distance < bestDistance || (distance == bestDistance && index < bestIndex))
+            {
+                bestPosition = candidate;
+                bestDistance = distance;
+                bestIndex = index;
+            }
+        };
+
+        // Rings visit about numBins / numPoints bins until the nearest cell is found
+        const auto numPoints = static_cast<unsigned long long>(points_.size());
+        if (numPoints * numPoints <= bins_.size())
+        {
+            for (const IntVector4& candidate : points_)
+                updateBest(candidate);
+            return bestPosition;
+        }
+
+        const IntVector4 centerBin = GetBin(position);
+
+        for (int ring = 0; ring < numBins_; ++ring)
+        {
+            // Enumerate bins on the surface of the cube of bins with given radius, clipped by the grid
+            IntVector4 binBegin;
+            IntVector4 binEnd;
+            for (int i = 0; i < 4; ++i)
+            {
+                binBegin[i] = ea::max(0, centerBin[i] - ring);
+                binEnd[i] = ea::min(numBins_ - 1, centerBin[i] + ring);
+            }
+
+            IntVector4 bin = binBegin;
+            while (true)
+            {
+                if (IsOnRing(bin - centerBin, ring) && GetDistanceToBin(position, bin) <= bestDistance)
+                {
+                    for (const IntVector4& candidate : bins_[GetBinIndex(bin)])
+                        updateBest(candidate);
+                }
+
+                int axis = 0;
+                while (axis < 4 && bin[axis] == binEnd[axis])
+                {
+                    bin[axis] = binBegin[axis];
+                    ++axis;
+                }
+                if (axis == 4)
+                    break;
+                ++bin[axis];
+            }
+
+            // Cells in the next ring are at least this far
+            if (bestDistance <= ring * binSize_)
+                break;
+        }
+        return bestPosition;
+    }
+
+    void InvalidateCache()
+    {
+        if (++version_ == 0)
+        {
+            nearestCache_.Clear();
+            version_ = 1;
+        }
+    }
+
+    static int GetManhattanDistance(const IntVector4& lhs, const IntVector4& rhs)
+    {
+        int result = 0;
+        for (int i = 0; i < 4; ++i)
+            result += Abs(lhs[i] - rhs[i]);
+        return result;
+    }
+
+    /// Return Manhattan distance from the position to the nearest cell of the bin.
+    int GetDistanceToBin(const IntVector4& position, const IntVector4& bin) const
+    {
+        int result = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const int begin = bin[i] * binSize_;
+            const int end = begin + binSize_ - 1;
+            result += ea::max(0, ea::max(begin - position[i], position[i] - end));
+        }
+        return result;
+    }
+
+    static bool IsOnRing(const IntVector4& offset, int ring)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            if (Abs(offset[i]) == ring)
+                return true;
+        }
+        return false;
+    }
+
+    IntVector4 GetBin(const IntVector4& position) const
+    {
+        IntVector4 bin;
+        for (int i = 0; i < 4; ++i)
+            bin[i] = Clamp(position[i], 0, gridSize_ - 1) / binSize_;
+        return bin;
+    }
+
+    unsigned GetBinIndex(const IntVector4& bin) const
+    {
+        return static_cast<unsigned>(((bin[3] * numBins_ + bin[2]) * numBins_ + bin[1]) * numBins_ + bin[0]);
+    }
+
+    int gridSize_{};
+    int binSize_{};
+    /// Number of bins along each axis.
+    int numBins_{};
+    ea::vector<ea::vector<IntVector4>> bins_;
+    /// All cells in insertion order, with holes filled by the last cell.
+    ea::vector<IntVector4> points_;
+
+    /// Nearest cell for each query cell, valid if its version matches current one.
+    mutable GridChunkedArray4D<CachedQuery> nearestCache_;
+    unsigned version_{};
+};
+
+}
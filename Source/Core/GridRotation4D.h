@@ -0,0 +1,257 @@
+#pragma once
+
+#include "Math4D.h"
+
+namespace Urho3D
+{
+
+/// Signed axis direction encoded as axis * 2 + (positive ? 1 : 0).
+/// Matches the order of neighbors in GridPathFinder4D.
+using GridDirection4D = unsigned char;
+
+/// Index of proper rotation of the grid, see GridRotation4D.
+using GridRotationIndex = unsigned char;
+
+static const unsigned NumGridDirections = 8;
+static const unsigned NumGridRotations = 192;
+
+inline constexpr GridDirection4D MakeGridDirection(int axis, int sign)
+{
+    return static_cast<GridDirection4D>(axis * 2 + (sign > 0 ? 1 : 0));
+}
+
+inline constexpr int GetDirectionAxis(GridDirection4D direction) { return direction / 2; }
+
+inline constexpr int GetDirectionSign(GridDirection4D direction) { return direction % 2 ? 1 : -1; }
+
+inline constexpr GridDirection4D ReverseDirection(GridDirection4D direction) { return direction ^ 1; }
+
+inline GridDirection4D IntVectorToDirection(const IntVector4& value)
+{
+    const auto axis = IntVectorToAxis(value);
+    return MakeGridDirection(axis.first, axis.second);
+}
+
+inline const IntVector4& DirectionToIntVector(GridDirection4D direction)
+{
+    static const IntVector4 vectors[NumGridDirections] = {
+        { -1, 0, 0, 0 }, { 1, 0, 0, 0 },
+        { 0, -1, 0, 0 }, { 0, 1, 0, 0 },
+        { 0, 0, -1, 0 }, { 0, 0, 1, 0 },
+        { 0, 0, 0, -1 }, { 0, 0, 0, 1 },
+    };
+    return vectors[direction];
+}
+
+/// Rotation of the grid that maps axes onto axes.
+/// Axis i is mapped onto axis axes_[i] with sign signs_[i].
+/// Only proper rotations (without reflection) are representable by index.
+struct GridRotation4D
+{
+    signed char axes_[4]{ 0, 1, 2, 3 };
+    signed char signs_[4]{ 1, 1, 1, 1 };
+
+    static constexpr GridRotation4D MakeIdentity() { return {}; }
+
+    /// Make quarter turn that maps direction "from" onto perpendicular direction "to".
+    /// Return identity if directions are equal.
+    static constexpr GridRotation4D MakeDelta(GridDirection4D from, GridDirection4D to)
+    {
+        GridRotation4D result;
+        if (from == to)
+            return result;
+
+        const int fromAxis = GetDirectionAxis(from);
+        const int toAxis = GetDirectionAxis(to);
+        assert(fromAxis != toAxis);
+
+        const int sign = GetDirectionSign(from) * GetDirectionSign(to);
+        result.axes_[fromAxis] = static_cast<signed char>(toAxis);
+        result.signs_[fromAxis] = static_cast<signed char>(sign);
+        result.axes_[toAxis] = static_cast<signed char>(fromAxis);
+        result.signs_[toAxis] = static_cast<signed char>(-sign);
+        return result;
+    }
+
+    static constexpr GridRotation4D FromIndex(GridRotationIndex index)
+    {
+        // Decode permutation from Lehmer code
+        const int factorials[4]{ 6, 2, 1, 1 };
+        int permutationCode = index / 8;
+        bool used[4]{};
+        int numInversions = 0;
+
+        GridRotation4D result;
+        for (int i = 0; i < 4; ++i)
+        {
+            int digit = permutationCode / factorials[i];
+            permutationCode %= factorials[i];
+            numInversions += digit;
+
+            for (int axis = 0; axis < 4; ++axis)
+            {
+                if (!used[axis] && digit-- == 0)
+                {
+                    used[axis] = true;
+                    result.axes_[i] = static_cast<signed char>(axis);
+                    break;
+                }
+            }
+        }
+
+        // Decode signs, the last sign is chosen to make rotation proper
+        int lastSign = numInversions % 2 ? -1 : 1;
+        for (int i = 0; i < 3; ++i)
+        {
+            result.signs_[i] = (index >> i) & 1 ? -1 : 1;
+            lastSign *= result.signs_[i];
+        }
+        result.signs_[3] = static_cast<signed char>(lastSign);
+        return result;
+    }
+
+    constexpr GridRotationIndex ToIndex() const
+    {
+        const int factorials[4]{ 6, 2, 1, 1 };
+        int permutationCode = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            int digit = 0;
+            for (int j = i + 1; j < 4; ++j)
+                digit += axes_[j] < axes_[i] ? 1 : 0;
+            permutationCode += digit * factorials[i];
+        }
+
+        int signBits = 0;
+        for (int i = 0; i < 3; ++i)
+            signBits |= signs_[i] < 0 ? (1 << i) : 0;
+
+        return static_cast<GridRotationIndex>(permutationCode * 8 + signBits);
+    }
+
+    /// Return rotation that applies rhs first and this rotation second.
+    constexpr GridRotation4D operator *(const GridRotation4D& rhs) const
+    {
+        GridRotation4D result;
+        for (int i = 0; i < 4; ++i)
+        {
+            result.axes_[i] = axes_[rhs.axes_[i]];
+            result.signs_[i] = static_cast<signed char>(signs_[rhs.axes_[i]] * rhs.signs_[i]);
+        }
+        return result;
+    }
+
+    constexpr GridRotation4D Inverted() const
+    {
+        GridRotation4D result;
+        for (int i = 0; i < 4; ++i)
+        {
+            result.axes_[axes_[i]] = static_cast<signed char>(i);
+            result.signs_[axes_[i]] = signs_[i];
+        }
+        return result;
+    }
+
+    constexpr GridDirection4D operator *(GridDirection4D direction) const
+    {
+        const int axis = GetDirectionAxis(direction);
+        return MakeGridDirection(axes_[axis], signs_[axis] * GetDirectionSign(direction));
+    }
+
+    IntVector4 operator *(const IntVector4& vec) const
+    {
+        IntVector4 result;
+        for (int i = 0; i < 4; ++i)
+            result[axes_[i]] = signs_[i] * vec[i];
+        return result;
+    }
+
+    Vector4 operator *(const Vector4& vec) const
+    {
+        Vector4 result;
+        for (int i = 0; i < 4; ++i)
+            result[axes_[i]] = signs_[i] * vec[i];
+        return result;
+    }
+
+    Matrix4 ToMatrix() const
+    {
+        float rotation[4][4]{};
+        for (int i = 0; i < 4; ++i)
+            rotation[axes_[i]][i] = static_cast<float>(signs_[i]);
+        return Matrix4{ &rotation[0][0] };
+    }
+};
+
+/// Composition, inverse and action tables of the grid rotation group.
+struct GridRotationTables
+{
+    /// Rotation that applies second index first and first index second.
+    GridRotationIndex compose_[NumGridRotations][NumGridRotations]{};
+    GridRotationIndex inverse_[NumGridRotations]{};
+    GridDirection4D action_[NumGridRotations][NumGridDirections]{};
+    /// Quarter turns between perpendicular directions, identity for equal or opposite directions.
+    GridRotationIndex delta_[NumGridDirections][NumGridDirections]{};
+};
+
+inline constexpr GridRotationTables MakeGridRotationTables()
+{
+    GridRotation4D rotations[NumGridRotations]{};
+    for (unsigned i = 0; i < NumGridRotations; ++i)
+        rotations[i] = GridRotation4D::FromIndex(static_cast<GridRotationIndex>(i));
+
+    GridRotationTables tables;
+    for (unsigned i = 0; i < NumGridRotations; ++i)
+    {
+        for (unsigned j = 0; j < NumGridRotations; ++j)
+            tables.compose_[i][j] = (rotations[i] * rotations[j]).ToIndex();
+
+        tables.inverse_[i] = rotations[i].Inverted().ToIndex();
+
+        for (unsigned j = 0; j < NumGridDirections; ++j)
+            tables.action_[i][j] = rotations[i] * static_cast<GridDirection4D>(j);
+    }
+
+    for (unsigned from = 0; from < NumGridDirections; ++from)
+    {
+        for (unsigned to = 0; to < NumGridDirections; ++to)
+        {
+            if (GetDirectionAxis(from) != GetDirectionAxis(to))
+            {
+                const auto delta = GridRotation4D::MakeDelta(static_cast<GridDirection4D>(from), static_cast<GridDirection4D>(to));
+                tables.delta_[from][to] = delta.ToIndex();
+            }
+        }
+    }
+    return tables;
+}
+
+/// Tables are generated at compile time. It may require increased limit of constexpr evaluation steps.
+inline constexpr GridRotationTables gridRotationTables = MakeGridRotationTables();
+
+static const GridRotationIndex IdentityGridRotation = 0;
+static_assert(GridRotation4D::MakeIdentity().ToIndex() == IdentityGridRotation, "Identity rotation must have zero index");
+
+/// Return rotation that applies rhs first and lhs second.
+inline constexpr GridRotationIndex ComposeRotations(GridRotationIndex lhs, GridRotationIndex rhs)
+{
+    return gridRotationTables.compose_[lhs][rhs];
+}
+
+inline constexpr GridRotationIndex InvertRotation(GridRotationIndex rotation)
+{
+    return gridRotationTables.inverse_[rotation];
+}
+
+inline constexpr GridDirection4D RotateDirection(GridRotationIndex rotation, GridDirection4D direction)
+{
+    return gridRotationTables.action_[rotation][direction];
+}
+
+/// Return quarter turn that maps direction "from" onto perpendicular direction "to".
+inline constexpr GridRotationIndex MakeDeltaRotation(GridDirection4D from, GridDirection4D to)
+{
+    return gridRotationTables.delta_[from][to];
+}
+
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Math4D.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Topology of the board: bounded box or torus where coordinates wrap modulo board size.
+/// Steps to adjacent cells and shortest deltas between cells are read from per-coordinate tables,
+/// which are identity ones for bounded board, so both topologies share branchless code without division.
+class GridTopology4D
+{
+public:
+    explicit GridTopology4D(int size = 0, bool wrapAround = false)
+    {
+        Reset(size, wrapAround);
+    }
+
+    void Reset(int size, bool wrapAround)
+    {
+        size_ = size;
+        wrapAround_ = wrapAround && size_ > 0;
+
+        // Coordinate after unit step is in range [-1, size]
+        stepTable_.resize(static_cast<unsigned>(size_ + 2));
+        for (int coordinate = -1; coordinate <= size_; ++coordinate)
+            stepTable_[coordinate + 1] = wrapAround_ ? (coordinate + size_) % size_ : coordinate;
+
+        // Coordinates may be one step outside of the board, so difference is in range [-size - 1, size + 1]
+        deltaTable_.resize(static_cast<unsigned>(2 * size_ + 3));
+        for (int delta = -size_ - 1; delta <= size_ + 1; ++delta)
+        {
+            int shortestDelta = delta;
+            if (wrapAround_)
+            {
+                shortestDelta = (delta % size_ + size_) % size_;
+                if (shortestDelta * 2 > size_)
+                    shortestDelta -= size_;
+            }
+            deltaTable_[delta + size_ + 1] = shortestDelta;
+        }
+
+        for (int i = 0; i < 4; ++i)
+        {
+            boxBegin_[i] = wrapAround_ ? M_MIN_INT : 0;
+            boxEnd_[i] = wrapAround_ ? M_MAX_INT : size_;
+        }
+    }
+
+    int GetSize() const { return size_; }
+
+    bool IsWrapAround() const { return wrapAround_; }
+
+    /// Return whether the cell is outside of the board, never true for torus.
+    bool IsOutside(const IntVector4& position) const { return !IsInside(position, boxBegin_, boxEnd_); }
+
+    /// Return cell adjacent to the position. Offset components should be in range [-1, 1].
+    /// Position before and after the step must be on the board or at most one cell outside of bounded board,
+    /// so cells outside may be stepped only back towards the board.
+    IntVector4 Step(const IntVector4& position, const IntVector4& offset) const
+    {
+        IntVector4 result;
+        for (int i = 0; i < 4; ++i)
+        {
+            assert(position[i] + offset[i] >= -1 && position[i] + offset[i] <= size_);
+            result[i] = stepTable_[position[i] + offset[i] + 1];
+        }
+        return result;
+    }
+
+    /// Return the shortest offset from one cell to another. Cells may be one step outside of bounded board.
+    IntVector4 GetDelta(const IntVector4& from, const IntVector4& to) const
+    {
+        IntVector4 result;
+        for (int i = 0; i < 4; ++i)
+            result[i] = deltaTable_[to[i] - from[i] + size_ + 1];
+        return result;
+    }
+
+    /// Return Manhattan distance between cells along the shortest offset.
+    int GetDistance(const IntVector4& from, const IntVector4& to) const
+    {
+        const IntVector4 delta = GetDelta(from, to);
+        return Abs(delta[0]) + Abs(delta[1]) + Abs(delta[2]) + Abs(delta[3]);
+    }
+
+    /// Return equivalent cell on the board for any position of torus. Slower than Step, for arbitrary offsets.
+    IntVector4 Wrap(const IntVector4& position) const
+    {
+        if (!wrapAround_)
+            return position;
+
+        IntVector4 result;
+        for (int i = 0; i < 4; ++i)
+            result[i] = (position[i] % size_ + size_) % size_;
+        return result;
+    }
+
+private:
+    int size_{};
+    bool wrapAround_{};
+    IntVector4 boxBegin_{};
+    IntVector4 boxEnd_{};
+
+    /// Coordinate after step for coordinates in range [-1, size], shifted by one.
+    ea::vector<int> stepTable_;
+    /// Shortest difference of coordinates for differences in range [-size - 1, size + 1], shifted by size + 1.
+    ea::vector<int> deltaTable_;
+};
+
+}
@@ -0,0 +1,306 @@
+#include "LevelPack.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+
+namespace Urho3D
+{
+
+namespace
+{
+
+const unsigned LevelPackMagic = 0x4C564C34; // "4LVL"
+const unsigned LevelPackVersion = 1;
+
+/// Max board size such that obstacle bitset is addressed by 32-bit cell indices.
+const int MaxLevelSize = GridObstacleSet4D::MaxGridSize;
+
+/// Number of cells of the snake laid at start.
+const int InitialSnakeLength = 3;
+
+unsigned long long AlignUp(unsigned long long value, unsigned long long alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+unsigned long long GetRecordSize(int size, unsigned numTargets)
+{
+    return sizeof(LevelRecordHeader)
+        + AlignUp(numTargets * sizeof(IntVector4), sizeof(unsigned long long))
+        + GridObstacleSet4D::GetNumWords(size) * sizeof(unsigned long long);
+}
+
+/// Hash level contents with FNV-1a.
+unsigned long long HashLevel(const LevelRecordHeader& header, ea::span<const IntVector4> targets,
+    ea::span<const unsigned long long> obstacleWords)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    const auto addBytes = [&](const void* data, unsigned long long size)
+    {
+        const auto bytes = static_cast<const unsigned char*>(data);
+        for (unsigned long long i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    addBytes(&header.size_, sizeof(header.size_));
+    addBytes(&header.startPosition_, sizeof(header.startPosition_));
+    addBytes(&header.startRotation_, sizeof(header.startRotation_));
+    addBytes(targets.data(), targets.size() * sizeof(IntVector4));
+    addBytes(obstacleWords.data(), obstacleWords.size() * sizeof(unsigned long long));
+    return hash;
+}
+
+bool IsInsideLevel(const IntVector4& position, int size)
+{
+    return IsInside(position, IntVector4{ 0, 0, 0, 0 }, IntVector4{ size, size, size, size });
+}
+
+}
+
+bool LevelPack::Open(const ea::string& fileName)
+{
+    Close();
+
+    if (!Map(fileName))
+        return false;
+
+    if (size_ < sizeof(LevelPackHeader) || header_->magic_ != LevelPackMagic || header_->version_ != LevelPackVersion
+        || size_ < sizeof(LevelPackHeader) + header_->numLevels_ * sizeof(unsigned long long))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool LevelPack::GetLevel(unsigned index, GameLevel& level) const
+{
+    if (index >= GetNumLevels())
+        return false;
+
+    const auto data = reinterpret_cast<const unsigned char*>(header_);
+    const auto offsets = reinterpret_cast<const unsigned long long*>(header_ + 1);
+    const unsigned long long offset = offsets[index];
+    if (offset % sizeof(unsigned long long) != 0 || offset > size_ || size_ - offset < sizeof(LevelRecordHeader))
+        return false;
+
+    const auto& record = *reinterpret_cast<const LevelRecordHeader*>(data + offset);
+    if (record.size_ <= 0 || record.size_ > MaxLevelSize || record.startRotation_ >= NumGridRotations
+        || size_ - offset < GetRecordSize(record.size_, record.numTargets_))
+        return false;
+
+    const auto targets = reinterpret_cast<const IntVector4*>(&record + 1);
+    const unsigned long long targetsSize = AlignUp(record.numTargets_ * sizeof(IntVector4), sizeof(unsigned long long));
+    const auto obstacleWords = reinterpret_cast<const unsigned long long*>(reinterpret_cast<const unsigned char*>(targets) + targetsSize);
+    const GridObstacleSet4D obstacles = record.numObstacles_ != 0 ? GridObstacleSet4D{ record.size_, obstacleWords } : GridObstacleSet4D{};
+
+    // Initial snake is laid behind the head, it must fit the board without wrapping and miss obstacles
+    const GridDirection4D startHeading = RotateDirection(static_cast<GridRotationIndex>(record.startRotation_), MakeGridDirection(2, 1));
+    const IntVector4& startDirection = DirectionToIntVector(startHeading);
+    for (int i = 0; i < InitialSnakeLength; ++i)
+    {
+        const IntVector4 position = record.startPosition_ - i * startDirection;
+        if (!IsInsideLevel(position, record.size_) || obstacles.Contains(position))
+            return false;
+    }
+
+    for (unsigned i = 0; i < record.numTargets_; ++i)
+    {
+        if (!IsInsideLevel(targets[i], record.size_) || obstacles.Contains(targets[i]))
+            return false;
+    }
+
+    level.size_ = record.size_;
+    level.startPosition_ = record.startPosition_;
+    level.startRotation_ = static_cast<GridRotationIndex>(record.startRotation_);
+    level.targets_ = { targets, record.numTargets_ };
+    level.obstacles_ = obstacles;
+    level.hash_ = record.hash_;
+    return true;
+}
+
+bool LevelPack::Write(const ea::string& fileName, ea::span<const LevelDescription> levels)
+{
+    const auto numLevels = static_cast<unsigned>(levels.size());
+
+    // Build the whole file in memory, it is written at once
+    unsigned long long fileSize = sizeof(LevelPackHeader) + numLevels * sizeof(unsigned long long);
+    ea::vector<unsigned long long> offsets(numLevels);
+    for (unsigned i = 0; i < numLevels; ++i)
+    {
+        const LevelDescription& level = levels[i];
+        if (level.size_ <= 0 || level.size_ > MaxLevelSize)
+            return false;
+
+        offsets[i] = fileSize;
+        fileSize += GetRecordSize(level.size_, level.targets_.size());
+    }
+
+    ea::vector<unsigned long long> buffer(fileSize / sizeof(unsigned long long));
+    const auto data = reinterpret_cast<unsigned char*>(buffer.data());
+
+    LevelPackHeader header{};
+    header.magic_ = LevelPackMagic;
+    header.version_ = LevelPackVersion;
+    header.numLevels_ = numLevels;
+    memcpy(data, &header, sizeof(header));
+    memcpy(data + sizeof(header), offsets.data(), numLevels * sizeof(unsigned long long));
+
+    for (unsigned i = 0; i < numLevels; ++i)
+    {
+        const LevelDescription& level = levels[i];
+        const auto record = reinterpret_cast<LevelRecordHeader*>(data + offsets[i]);
+        const auto targets = reinterpret_cast<IntVector4*>(record + 1);
+        const unsigned long long targetsSize = AlignUp(level.targets_.size() * sizeof(IntVector4), sizeof(unsigned long long));
+        const auto obstacleWords = reinterpret_cast<unsigned long long*>(reinterpret_cast<unsigned char*>(targets) + targetsSize);
+
+        const auto size = static_cast<unsigned>(level.size_);
+        for (const IntVector4& position : level.obstacles_)
+        {
+            if (!IsInsideLevel(position, level.size_))
+                return false;
+
+            const unsigned index = ((position[3] * size + position[2]) * size + position[1]) * size + position[0];
+            obstacleWords[index / GridObstacleSet4D::BitsPerWord] |= 1ull << (index % GridObstacleSet4D::BitsPerWord);
+        }
+
+        record->size_ = level.size_;
+        record->numTargets_ = level.targets_.size();
+        record->startPosition_ = level.startPosition_;
+        record->startRotation_ = level.startRotation_;
+        record->numObstacles_ = level.obstacles_.size();
+        ea::copy(level.targets_.begin(), level.targets_.end(), targets);
+        record->hash_ = HashLevel(*record, { targets, record->numTargets_ },
+            { obstacleWords, GridObstacleSet4D::GetNumWords(level.size_) });
+    }
+
+    FILE* file = fopen(fileName.c_str(), "wb");
+    if (!file)
+        return false;
+
+    const bool written = fwrite(data, 1, fileSize, file) == fileSize;
+    return fclose(file) == 0 && written;
+}
+
+#if defined(_WIN32)
+
+bool LevelPack::Map(const ea::string& fileName)
+{
+    const HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize{};
+    const HANDLE mapping = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart != 0
+        ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr)
+        : nullptr;
+    // Mapping keeps the file open
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+
+    const void* memory = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!memory)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    size_ = static_cast<unsigned long long>(fileSize.QuadPart);
+    handle_ = mapping;
+    header_ = static_cast<const LevelPackHeader*>(memory);
+    return true;
+}
+
+void LevelPack::Close()
+{
+    if (header_)
+        UnmapViewOfFile(header_);
+    if (handle_)
+        CloseHandle(static_cast<HANDLE>(handle_));
+
+    size_ = 0;
+    handle_ = nullptr;
+    header_ = nullptr;
+}
+
+#elif !defined(__EMSCRIPTEN__)
+
+bool LevelPack::Map(const ea::string& fileName)
+{
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info{};
+    const bool sizeReady = fstat(fd, &info) == 0 && info.st_size != 0;
+    // Pages are loaded on first access, so opening does not depend on the number of levels
+    void* memory = sizeReady ? mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (memory == MAP_FAILED)
+        return false;
+
+    size_ = static_cast<unsigned long long>(info.st_size);
+    header_ = static_cast<const LevelPackHeader*>(memory);
+    return true;
+}
+
+void LevelPack::Close()
+{
+    if (header_)
+        munmap(const_cast<LevelPackHeader*>(header_), size_);
+
+    size_ = 0;
+    header_ = nullptr;
+}
+
+#else
+
+bool LevelPack::Map(const ea::string& fileName)
+{
+    // Memory mapping is not available on the web, read the whole file instead
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (!file)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    const long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    buffer_.resize((static_cast<unsigned long long>(ea::max(fileSize, 0l)) + 7) / 8);
+    const bool loaded = fileSize > 0 && fread(buffer_.data(), 1, fileSize, file) == static_cast<size_t>(fileSize);
+    fclose(file);
+    if (!loaded)
+    {
+        buffer_.clear();
+        return false;
+    }
+
+    size_ = static_cast<unsigned long long>(fileSize);
+    header_ = reinterpret_cast<const LevelPackHeader*>(buffer_.data());
+    return true;
+}
+
+void LevelPack::Close()
+{
+    buffer_.clear();
+    size_ = 0;
+    header_ = nullptr;
+}
+
+#endif
+
+}
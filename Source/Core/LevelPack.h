@@ -0,0 +1,100 @@
+#pragma once
+
+#include "GridObstacleSet4D.h"
+#include "GridRotation4D.h"
+
+#include <EASTL/span.h>
+#include <EASTL/string.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Header of level pack file. It is followed by file offsets of levels and level records.
+/// All values are stored in native byte order, so records are used in place without parsing.
+struct LevelPackHeader
+{
+    unsigned magic_;
+    unsigned version_;
+    unsigned numLevels_;
+    unsigned reserved_;
+};
+
+/// Header of level record, aligned to 8 bytes. It is followed by target sequence and obstacle bitset,
+/// both aligned to 8 bytes.
+struct LevelRecordHeader
+{
+    int size_;
+    unsigned numTargets_;
+    IntVector4 startPosition_;
+    /// Camera rotation at start, snake heads along rotated +Z axis.
+    unsigned startRotation_;
+    unsigned numObstacles_;
+    /// Hash of the level contents, equal levels have equal hashes.
+    unsigned long long hash_;
+};
+
+static_assert(sizeof(LevelPackHeader) == 16, "Level pack header must be packed");
+static_assert(sizeof(LevelRecordHeader) == 40, "Level record header must be packed");
+
+/// Level viewed in place, valid while the pack is open.
+struct GameLevel
+{
+    int size_{};
+    IntVector4 startPosition_{};
+    GridRotationIndex startRotation_{};
+    /// Predefined targets, random targets are spawned after them.
+    ea::span<const IntVector4> targets_;
+    GridObstacleSet4D obstacles_;
+    unsigned long long hash_{};
+};
+
+/// Level description used to write level packs.
+struct LevelDescription
+{
+    int size_{};
+    IntVector4 startPosition_{};
+    GridRotationIndex startRotation_{};
+    ea::vector<IntVector4> targets_;
+    ea::vector<IntVector4> obstacles_;
+};
+
+/// Read-only pack of levels, memory-mapped and used in place.
+/// Opening the pack checks only the header, levels are validated when accessed.
+/// Packs are used by tools only (LevelPackBenchmark, ReplayVerifier), the game itself has no shipped levels.
+class LevelPack
+{
+public:
+    LevelPack() = default;
+    ~LevelPack() { Close(); }
+
+    LevelPack(const LevelPack&) = delete;
+    LevelPack& operator=(const LevelPack&) = delete;
+
+    /// Map level pack file into memory.
+    bool Open(const ea::string& fileName);
+    /// Unmap the file. Levels returned by GetLevel become invalid.
+    void Close();
+
+    bool IsOpen() const { return header_ != nullptr; }
+
+    unsigned GetNumLevels() const { return header_ ? header_->numLevels_ : 0; }
+
+    /// Return view of the level. Return false if the record is corrupted or the level is not playable:
+    /// initial snake or targets are outside of the board or on obstacles.
+    bool GetLevel(unsigned index, GameLevel& level) const;
+
+    /// Write levels to level pack file.
+    static bool Write(const ea::string& fileName, ea::span<const LevelDescription> levels);
+
+private:
+    bool Map(const ea::string& fileName);
+
+    unsigned long long size_{};
+    void* handle_{};
+    const LevelPackHeader* header_{};
+    /// File contents on platforms without memory mapping.
+    ea::vector<unsigned long long> buffer_;
+};
+
+}
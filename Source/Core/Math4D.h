@@ -1,5 +1,7 @@
 #pragma once
 
+#include "RandomGenerator.h"
+
 #include <Urho3D/Math/MathDefs.h>
 #include <Urho3D/Math/Matrix4.h>
 #include <Urho3D/Math/Vector4.h>
@@ -43,16 +45,25 @@ inline int DotProduct(const IntVector4& lhs, const IntVector4& rhs)
     return result;
 }
 
-inline IntVector4 RandomIntVector4(int range)
+inline IntVector4 RandomIntVector4(RandomGenerator& random, int range)
 {
     IntVector4 result;
-    result[0] = Random(range);
-    result[1] = Random(range);
-    result[2] = Random(range);
-    result[3] = Random(range);
+    for (int i = 0; i < 4; ++i)
+        result[i] = static_cast<int>(random.Next(static_cast<unsigned>(range)));
     return result;
 }
 
+/// Max board size such that flattened cell indices fit into 64 bits.
+static const int MaxGridSize = (1 << 16) - 1;
+
+/// Return index of the cell in row-major order. Boards of 256 cells and more along each axis
+/// have more than 2^32 cells, so the index is 64-bit.
+inline unsigned long long FlattenGridIndex(const IntVector4& pos, int gridSize)
+{
+    const auto size = static_cast<unsigned long long>(gridSize);
+    return ((static_cast<unsigned long long>(pos[3]) * size + pos[2]) * size + pos[1]) * size + pos[0];
+}
+
 inline ea::pair<int, int> IntVectorToAxis(const IntVector4& value)
 {
     const unsigned numNonZero = (value[0] != 0) + (value[1] != 0) + (value[2] != 0) + (value[3] != 0);
@@ -88,30 +99,6 @@ inline IntVector4 RoundVector4(const Vector4& vec)
     return { RoundToInt(vec.x_), RoundToInt(vec.y_), RoundToInt(vec.z_), RoundToInt(vec.w_) };
 }
 
-inline Matrix4 MakeDeltaRotation(const IntVector4& from, const IntVector4& to)
-{
-    if (from == to)
-        return Matrix4::IDENTITY;
-
-    const auto fromAxis = IntVectorToAxis(from);
-    const auto toAxis = IntVectorToAxis(to);
-
-    // Fill identity part of the matrix
-    float rotation[4][4]{};
-    for (unsigned i = 0; i < 4; ++i)
-    {
-        if (i != fromAxis.first && i != toAxis.first)
-            rotation[i][i] = 1.0f;
-    }
-
-    // Fill rotation part of the matrix
-    const float sign = static_cast<float>(fromAxis.second * toAxis.second);
-    rotation[fromAxis.first][toAxis.first] = -sign;
-    rotation[toAxis.first][fromAxis.first] = sign;
-
-    return Matrix4{ &rotation[0][0] };
-}
-
 struct Matrix4x5
 {
     Matrix4 rotation_;
@@ -0,0 +1,258 @@
+#include "MonteCarloPlanner.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Return position of snake head after the action.
+IntVector4 GetNextHeadPosition(const GameSimulation& sim, UserAction action)
+{
+    const GridCamera4D& camera = sim.GetCamera();
+    const GridRotationIndex rotation = ComposeRotations(camera.GetCurrentRotation(), GetActionRotation(action).rotation_);
+    return sim.GetTopology().Step(camera.GetCurrentPosition(), DirectionToIntVector(RotateDirection(rotation, MakeGridDirection(2, 1))));
+}
+
+/// Return whether the action does not move snake head into wall or snake body.
+bool IsActionSafe(const GameSimulation& sim, UserAction action)
+{
+    const IntVector4 nextPosition = GetNextHeadPosition(sim, action);
+    return !sim.IsOutside(nextPosition) && !sim.IsOccupied(nextPosition);
+}
+
+}
+
+MonteCarloPlanner::MonteCarloPlanner(int size, unsigned numWorkers)
+    : pool_(numWorkers)
+{
+    const unsigned numTrees = pool_.GetNumThreads() * TreesPerThread;
+    for (unsigned i = 0; i < numTrees; ++i)
+    {
+        trees_.push_back(ea::make_unique<SearchTree>(size));
+        trees_.back()->random_.SetSeed(i);
+        trees_.back()->sim_.SetUpdateBestAction(false);
+    }
+}
+
+UserAction MonteCarloPlanner::PlanAction(const GameSimulation& sim)
+{
+    lastNumIterations_ = 0;
+    if (sim.IsGameOver())
+        return UserAction::None;
+
+    const auto budget = std::chrono::duration<float>(settings_.timeBudget_);
+    const Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(budget);
+
+    sim.SaveState(rootState_);
+    for (const auto& tree : trees_)
+    {
+        tree->sim_.CopySettings(sim);
+        tree->nodes_.clear();
+        tree->nodes_.push_back(Node{});
+        tree->numIterations_ = 0;
+    }
+
+    for (const auto& tree : trees_)
+    {
+        SearchTree* searchTree = tree.get();
+        pool_.Submit([this, searchTree, deadline] { RunTask(*searchTree, deadline); });
+    }
+    pool_.Wait();
+
+    // Merge statistics of root children
+    unsigned visits[NumActions]{};
+    float values[NumActions]{};
+    for (const auto& tree : trees_)
+    {
+        lastNumIterations_ += tree->numIterations_;
+
+        const Node& root = tree->nodes_[0];
+        if (!root.expanded_)
+            continue;
+
+        for (unsigned i = 0; i < NumActions; ++i)
+        {
+            const Node& child = tree->nodes_[root.firstChild_ + i];
+            visits[i] += child.visits_;
+            values[i] += child.totalValue_;
+        }
+    }
+
+    // Pick the most visited action, fall back to path finder if there was no time to search
+    const UserAction pathAction = sim.GetBestAction();
+    UserAction bestAction = pathAction;
+    unsigned bestVisits = 0;
+    float bestValue = 0.0f;
+    for (unsigned i = 0; i < NumActions; ++i)
+    {
+        const float value = visits[i] ? values[i] / visits[i] : 0.0f;
+        if (visits[i] > bestVisits || (visits[i] == bestVisits && visits[i] != 0 && value > bestValue))
+        {
+            bestAction = static_cast<UserAction>(i);
+            bestVisits = visits[i];
+            bestValue = value;
+        }
+    }
+
+    // Rollout values of safe actions are close, so keep following the path unless search found it worse
+    const unsigned pathIndex = static_cast<unsigned>(pathAction);
+    if (pathIndex < NumActions && visits[pathIndex] != 0
+        && values[pathIndex] / visits[pathIndex] + settings_.pathFinderMargin_ >= bestValue)
+        bestAction = pathAction;
+    return bestAction;
+}
+
+void MonteCarloPlanner::RunTask(SearchTree& tree, Clock::time_point deadline)
+{
+    for (unsigned i = 0; i < settings_.iterationsPerTask_; ++i)
+    {
+        // Stop early if the next iteration may not fit into the budget
+        const Clock::time_point startTime = Clock::now();
+        if (startTime + 2 * tree.maxIterationTime_ >= deadline)
+            return;
+
+        RunIteration(tree);
+        tree.maxIterationTime_ = ea::max(tree.maxIterationTime_, Clock::now() - startTime);
+    }
+
+    SearchTree* searchTree = &tree;
+    pool_.Submit([this, searchTree, deadline] { RunTask(*searchTree, deadline); });
+}
+
+void MonteCarloPlanner::RunIteration(SearchTree& tree)
+{
+    GameSimulation& sim = tree.sim_;
+    sim.RestoreState(rootState_);
+
+    unsigned numTicks = 0;
+    unsigned numTargets = 0;
+    unsigned firstTargetTick = 0;
+    const auto tick = [&](UserAction action)
+    {
+        // Any of the targets may be eaten
+        const bool eatsTarget = !sim.IsGameOver() && sim.IsTarget(GetNextHeadPosition(sim, action));
+        sim.SetNextAction(action);
+        sim.Tick();
+        ++numTicks;
+        if (eatsTarget && !sim.IsGameOver())
+        {
+            if (numTargets++ == 0)
+                firstTargetTick = numTicks;
+        }
+    };
+
+    // Select leaf
+    unsigned nodeIndex = 0;
+    tree.path_.clear();
+    tree.path_.push_back(nodeIndex);
+    while (tree.nodes_[nodeIndex].expanded_ && !sim.IsGameOver())
+    {
+        const unsigned childIndex = SelectChild(tree, nodeIndex);
+        tick(static_cast<UserAction>(childIndex - tree.nodes_[nodeIndex].firstChild_));
+        nodeIndex = childIndex;
+        tree.path_.push_back(nodeIndex);
+    }
+
+    // Expand leaf
+    if (!sim.IsGameOver())
+    {
+        const unsigned firstChild = tree.nodes_.size();
+        tree.nodes_[nodeIndex].expanded_ = true;
+        tree.nodes_[nodeIndex].firstChild_ = firstChild;
+        tree.nodes_.resize(firstChild + NumActions);
+
+        // Don't waste iterations on immediate collisions
+        for (unsigned i = 0; i < NumActions; ++i)
+            tree.nodes_[firstChild + i].fatal_ = !IsActionSafe(sim, static_cast<UserAction>(i));
+    }
+
+    // Simulate
+    for (unsigned i = 0; i < settings_.rolloutDepth_ && !sim.IsGameOver(); ++i)
+        tick(GetRolloutAction(tree));
+
+    // Propagate result
+    const float value = Evaluate(sim, numTicks, numTargets, firstTargetTick);
+    for (unsigned pathNodeIndex : tree.path_)
+    {
+        Node& node = tree.nodes_[pathNodeIndex];
+        ++node.visits_;
+        node.totalValue_ += value;
+    }
+    ++tree.numIterations_;
+}
+
+unsigned MonteCarloPlanner::SelectChild(const SearchTree& tree, unsigned nodeIndex) const
+{
+    const Node& node = tree.nodes_[nodeIndex];
+    const float logVisits = logf(static_cast<float>(ea::max(1u, node.visits_)));
+
+    unsigned bestChild = node.firstChild_;
+    float bestScore = -M_INFINITY;
+    for (unsigned i = 0; i < NumActions; ++i)
+    {
+        const Node& child = tree.nodes_[node.firstChild_ + i];
+        if (child.fatal_)
+            continue;
+        if (child.visits_ == 0)
+            return node.firstChild_ + i;
+
+        const float exploitation = child.totalValue_ / child.visits_;
+        const float exploration = settings_.explorationConstant_ * sqrtf(logVisits / child.visits_);
+        if (exploitation + exploration > bestScore)
+        {
+            bestScore = exploitation + exploration;
+            bestChild = node.firstChild_ + i;
+        }
+    }
+    return bestChild;
+}
+
+UserAction MonteCarloPlanner::GetRolloutAction(SearchTree& tree) const
+{
+    const GameSimulation& sim = tree.sim_;
+    const GridCamera4D& camera = sim.GetCamera();
+    const IntVector4& headPosition = camera.GetCurrentPosition();
+    const IntVector4 targetPosition = sim.FindNearestTarget(headPosition);
+    const bool randomAction = tree.random_.Next(1000u) < static_cast<unsigned>(settings_.rolloutNoise_ * 1000.0f);
+
+    // Greedily approach target through free cells, skip equivalent roll action
+    UserAction bestAction = UserAction::None;
+    int bestScore = M_MIN_INT;
+    for (unsigned i = 0; i < static_cast<unsigned>(UserAction::XRoll); ++i)
+    {
+        const auto action = static_cast<UserAction>(i);
+        if (!IsActionSafe(sim, action))
+            continue;
+
+        const IntVector4 nextPosition = GetNextHeadPosition(sim, action);
+        const int score = randomAction
+            ? static_cast<int>(tree.random_.Next(1000u))
+            : -sim.GetTopology().GetDistance(nextPosition, targetPosition) * 4 + static_cast<int>(tree.random_.Next(4u));
+        if (score > bestScore)
+        {
+            bestAction = action;
+            bestScore = score;
+        }
+    }
+    return bestAction;
+}
+
+float MonteCarloPlanner::Evaluate(const GameSimulation& sim, unsigned numTicks, unsigned numTargets, unsigned firstTargetTick) const
+{
+    const float maxTicks = static_cast<float>(ea::max(1u, settings_.rolloutDepth_));
+
+    // Dying later is better than dying sooner
+    if (sim.IsGameOver())
+        return 0.1f * ea::min(1.0f, numTicks / maxTicks);
+
+    // Reaching target sooner is better
+    if (numTargets > 0)
+        return 1.0f - 0.4f * ea::min(1.0f, firstTargetTick / maxTicks);
+
+    const float maxDistance = 4.0f * sim.GetSize();
+    const float closeness = 1.0f - sim.GetTopology().GetDistance(sim.GetSnakeHead(), sim.FindNearestTarget(sim.GetSnakeHead())) / maxDistance;
+    return 0.2f + 0.4f * closeness;
+}
+
+}
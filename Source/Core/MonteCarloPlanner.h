@@ -0,0 +1,91 @@
+#pragma once
+
+#include "GameSimulation.h"
+#include "RandomGenerator.h"
+#include "WorkStealingPool.h"
+
+#include <EASTL/unique_ptr.h>
+#include <EASTL/vector.h>
+
+#include <chrono>
+
+namespace Urho3D
+{
+
+struct MonteCarloSettings
+{
+    /// Time budget of single decision in seconds.
+    float timeBudget_{ 0.02f };
+    /// Number of ticks simulated after reaching tree leaf.
+    unsigned rolloutDepth_{ 24 };
+    float explorationConstant_{ 0.1f };
+    /// Probability of random action in rollouts.
+    float rolloutNoise_{ 0.05f };
+    /// Number of iterations done by single task before it is resubmitted.
+    unsigned iterationsPerTask_{ 8 };
+    /// Path finder action is kept unless its value is worse than the best value by more than this margin.
+    float pathFinderMargin_{ 0.05f };
+};
+
+/// Chooses next action with Monte Carlo tree search over cloned simulation states.
+/// Independent trees are grown in parallel on work stealing pool and merged at the root.
+class MonteCarloPlanner
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    MonteCarloPlanner(int size, unsigned numWorkers);
+
+    void SetSettings(const MonteCarloSettings& settings) { settings_ = settings; }
+
+    const MonteCarloSettings& GetSettings() const { return settings_; }
+
+    /// Return best action for current state of simulation. Returns before time budget expires.
+    UserAction PlanAction(const GameSimulation& sim);
+
+    /// Return number of iterations done by last call of PlanAction.
+    unsigned GetLastNumIterations() const { return lastNumIterations_; }
+
+private:
+    static const unsigned NumActions = static_cast<unsigned>(UserAction::Count);
+    /// Number of independent trees per thread, spare trees let idle threads steal work.
+    static const unsigned TreesPerThread = 2;
+
+    struct Node
+    {
+        unsigned firstChild_{};
+        unsigned visits_{};
+        float totalValue_{};
+        bool expanded_{};
+        /// Action of this node moves into wall or snake body.
+        bool fatal_{};
+    };
+
+    struct SearchTree
+    {
+        explicit SearchTree(int size) : sim_(size) {}
+
+        GameSimulation sim_;
+        RandomGenerator random_;
+        ea::vector<Node> nodes_;
+        ea::vector<unsigned> path_;
+        unsigned numIterations_{};
+        /// Longest iteration observed, used to stop before deadline.
+        Clock::duration maxIterationTime_{};
+    };
+
+    void RunTask(SearchTree& tree, Clock::time_point deadline);
+    void RunIteration(SearchTree& tree);
+    unsigned SelectChild(const SearchTree& tree, unsigned nodeIndex) const;
+    UserAction GetRolloutAction(SearchTree& tree) const;
+    float Evaluate(const GameSimulation& sim, unsigned numTicks, unsigned numTargets, unsigned firstTargetTick) const;
+
+    MonteCarloSettings settings_;
+    WorkStealingPool pool_;
+    ea::vector<ea::unique_ptr<SearchTree>> trees_;
+
+    SimulationState rootState_;
+    unsigned lastNumIterations_{};
+};
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "GameSimulation.h"
+
+#include <cstring>
+
+namespace Urho3D
+{
+
+/// Channels of observation tensor, one byte per cell each.
+enum class ObservationChannel
+{
+    /// Cell is outside of the board.
+    Outside,
+    /// Cell is occupied by snake. Head is always in the center.
+    Snake,
+    /// Cell contains target.
+    Target,
+
+    Count
+};
+
+static const unsigned NumObservationChannels = static_cast<unsigned>(ObservationChannel::Count);
+
+/// Layout of egocentric observation tensor.
+/// Tensor is [channel][w][z][y][x] bytes in camera space, where X is right, Y is up, Z is heading and W is blue.
+/// Coordinates are in range [0, 2 * radius], head is at (radius, radius, radius, radius).
+struct ObservationLayout
+{
+    int radius_{ 5 };
+
+    unsigned GetDiameter() const { return static_cast<unsigned>(2 * radius_ + 1); }
+
+    unsigned GetChannelSize() const
+    {
+        const unsigned diameter = GetDiameter();
+        return diameter * diameter * diameter * diameter;
+    }
+
+    unsigned GetTensorSize() const { return NumObservationChannels * GetChannelSize(); }
+};
+
+/// Scalar part of observation stored next to the tensor.
+struct ObservationScalars
+{
+    /// Number of ticks since the game was reset.
+    unsigned step_{};
+    unsigned snakeLength_{};
+    unsigned char gameOver_{};
+    /// Camera rotation in world space.
+    GridRotationIndex rotation_{};
+    /// Snake heading in world space.
+    GridDirection4D heading_{};
+    /// Offset from head to the nearest target in camera space, not clamped by observation radius.
+    int targetOffset_[4]{};
+};
+
+/// Encode egocentric view around current camera frame of the simulation.
+/// Tensor should have layout.GetTensorSize() bytes and is fully overwritten.
+inline void EncodeObservation(const GameSimulation& sim, const ObservationLayout& layout, unsigned step,
+    ObservationScalars& scalars, unsigned char* tensor)
+{
+    const GridCamera4D& camera = sim.GetCamera();
+    const IntVector4 head = camera.GetCurrentPosition();
+    const IntVector4 axes[4] = { camera.GetCurrentRight(), camera.GetCurrentUp(), camera.GetCurrentDirection(), camera.GetCurrentBlue() };
+    const IntVector4 target = sim.FindNearestTarget(head);
+
+    scalars.step_ = step;
+    scalars.snakeLength_ = sim.GetSnakeLength();
+    scalars.gameOver_ = sim.IsGameOver();
+    scalars.rotation_ = camera.GetCurrentRotation();
+    scalars.heading_ = camera.GetCurrentHeading();
+    for (int i = 0; i < 4; ++i)
+        scalars.targetOffset_[i] = DotProduct(sim.GetTopology().GetDelta(head, target), axes[i]);
+
+    const unsigned channelSize = layout.GetChannelSize();
+    unsigned char* outside = tensor + static_cast<unsigned>(ObservationChannel::Outside) * channelSize;
+    unsigned char* snake = tensor + static_cast<unsigned>(ObservationChannel::Snake) * channelSize;
+    unsigned char* targets = tensor + static_cast<unsigned>(ObservationChannel::Target) * channelSize;
+    memset(tensor, 0, layout.GetTensorSize());
+
+    const GridTopology4D& topology = sim.GetTopology();
+    const bool wrapAround = topology.IsWrapAround();
+
+    // Walk camera-space grid with incremental world positions
+    const int radius = layout.radius_;
+    const IntVector4 origin = head - radius * (axes[0] + axes[1] + axes[2] + axes[3]);
+    unsigned cell = 0;
+    IntVector4 positionW = origin;
+    for (int w = -radius; w <= radius; ++w, positionW = positionW + axes[3])
+    {
+        IntVector4 positionZ = positionW;
+        for (int z = -radius; z <= radius; ++z, positionZ = positionZ + axes[2])
+        {
+            IntVector4 positionY = positionZ;
+            for (int y = -radius; y <= radius; ++y, positionY = positionY + axes[1])
+            {
+                IntVector4 position = positionY;
+                for (int x = -radius; x <= radius; ++x, position = position + axes[0], ++cell)
+                {
+                    // Camera-space window may span the board several times on wrapped board
+                    const IntVector4 boardPosition = wrapAround ? topology.Wrap(position) : position;
+                    if (sim.IsOutside(boardPosition))
+                        outside[cell] = 1;
+                    else if (sim.IsOccupied(boardPosition))
+                        snake[cell] = 1;
+                    else if (sim.IsTarget(boardPosition))
+                        targets[cell] = 1;
+                }
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cassert>
+
+namespace Urho3D
+{
+
+/// Small seeded PCG32 generator. Each simulation owns one, so runs are reproducible
+/// and independent simulations never share random state.
+class RandomGenerator
+{
+    static const unsigned long long Multiplier = 6364136223846793005ull;
+    static const unsigned long long Increment = 1442695040888963407ull;
+
+public:
+    explicit RandomGenerator(unsigned long long seed = 0)
+    {
+        SetSeed(seed);
+    }
+
+    void SetSeed(unsigned long long seed)
+    {
+        state_ = 0;
+        Next();
+        state_ += seed;
+        Next();
+    }
+
+    /// Return uniformly distributed 32-bit value.
+    unsigned Next()
+    {
+        const unsigned long long oldState = state_;
+        state_ = oldState * Multiplier + Increment;
+        const auto xorShifted = static_cast<unsigned>(((oldState >> 18u) ^ oldState) >> 27u);
+        const auto rotation = static_cast<unsigned>(oldState >> 59u);
+        return (xorShifted >> rotation) | (xorShifted << ((32u - rotation) & 31u));
+    }
+
+    /// Return value in range [0, range).
+    unsigned Next(unsigned range)
+    {
+        assert(range > 0);
+        return static_cast<unsigned>((static_cast<unsigned long long>(Next()) * range) >> 32u);
+    }
+
+private:
+    unsigned long long state_{};
+};
+
+}
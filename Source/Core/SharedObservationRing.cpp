@@ -0,0 +1,175 @@
+#include "SharedObservationRing.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <new>
+
+namespace Urho3D
+{
+
+namespace
+{
+
+const unsigned ObservationRingMagic = 0x34534F42; // "BOS4"
+const unsigned ObservationRingVersion = 1;
+
+unsigned AlignUp(unsigned value, unsigned alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+bool SharedObservationRing::Create(const ea::string& name, const ObservationLayout& layout, unsigned numSlots)
+{
+    Close();
+
+    if (numSlots == 0)
+        return false;
+
+    const unsigned slotStride = AlignUp(sizeof(SharedObservationSlot) + layout.GetTensorSize(), alignof(SharedObservationSlot));
+    const unsigned size = sizeof(SharedObservationHeader) + numSlots * slotStride;
+    if (!Map(name, size, true))
+        return false;
+
+    owner_ = true;
+    header_ = new (header_) SharedObservationHeader{};
+    header_->magic_ = ObservationRingMagic;
+    header_->version_ = ObservationRingVersion;
+    header_->numSlots_ = numSlots;
+    header_->slotStride_ = slotStride;
+    header_->layout_ = layout;
+    for (unsigned i = 0; i < numSlots; ++i)
+        new (&GetSlot(i)) SharedObservationSlot{};
+    return true;
+}
+
+bool SharedObservationRing::Open(const ea::string& name)
+{
+    Close();
+
+    if (!Map(name, 0, false))
+        return false;
+
+    if (size_ < sizeof(SharedObservationHeader) || header_->magic_ != ObservationRingMagic
+        || header_->version_ != ObservationRingVersion
+        || size_ < sizeof(SharedObservationHeader) + header_->numSlots_ * header_->slotStride_)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+#if defined(_WIN32)
+
+bool SharedObservationRing::Map(const ea::string& name, unsigned size, bool create)
+{
+    const HANDLE mapping = create
+        ? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, size, name.c_str())
+        : OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+    if (!mapping)
+        return false;
+
+    void* memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!memory)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    if (!create)
+    {
+        MEMORY_BASIC_INFORMATION info{};
+        VirtualQuery(memory, &info, sizeof(info));
+        size = static_cast<unsigned>(info.RegionSize);
+    }
+
+    name_ = name;
+    size_ = size;
+    handle_ = mapping;
+    header_ = static_cast<SharedObservationHeader*>(memory);
+    return true;
+}
+
+void SharedObservationRing::Close()
+{
+    if (header_)
+        UnmapViewOfFile(header_);
+    if (handle_)
+        CloseHandle(static_cast<HANDLE>(handle_));
+
+    name_.clear();
+    owner_ = false;
+    size_ = 0;
+    handle_ = nullptr;
+    header_ = nullptr;
+}
+
+#elif !defined(__EMSCRIPTEN__)
+
+bool SharedObservationRing::Map(const ea::string& name, unsigned size, bool create)
+{
+    // POSIX shared memory names start with slash
+    const ea::string posixName = "/" + name;
+    const int fd = create
+        ? shm_open(posixName.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600)
+        : shm_open(posixName.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        return false;
+
+    struct stat info{};
+    const bool sizeReady = create ? ftruncate(fd, size) == 0 : fstat(fd, &info) == 0;
+    if (!create)
+        size = static_cast<unsigned>(info.st_size);
+
+    void* memory = sizeReady && size != 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        if (create)
+            shm_unlink(posixName.c_str());
+        return false;
+    }
+
+    name_ = posixName;
+    size_ = size;
+    header_ = static_cast<SharedObservationHeader*>(memory);
+    return true;
+}
+
+void SharedObservationRing::Close()
+{
+    if (header_)
+        munmap(header_, size_);
+    if (owner_)
+        shm_unlink(name_.c_str());
+
+    name_.clear();
+    owner_ = false;
+    size_ = 0;
+    header_ = nullptr;
+}
+
+#else
+
+bool SharedObservationRing::Map(const ea::string& name, unsigned size, bool create)
+{
+    // Shared memory between processes is not available on the web
+    return false;
+}
+
+void SharedObservationRing::Close()
+{
+}
+
+#endif
+
+}
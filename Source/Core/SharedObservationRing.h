@@ -0,0 +1,114 @@
+#pragma once
+
+#include "ObservationEncoder.h"
+
+#include <EASTL/string.h>
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+/// Observation slot in shared memory. Tensor bytes follow the slot header.
+/// Sequence is odd while the slot is written and 2 * (index + 1) once observation with given index is published.
+struct alignas(64) SharedObservationSlot
+{
+    std::atomic<unsigned long long> sequence_;
+    ObservationScalars scalars_;
+
+    unsigned char* GetTensor() { return reinterpret_cast<unsigned char*>(this + 1); }
+    const unsigned char* GetTensor() const { return reinterpret_cast<const unsigned char*>(this + 1); }
+};
+
+/// Header of shared memory block, followed by slots.
+struct alignas(64) SharedObservationHeader
+{
+    unsigned magic_;
+    unsigned version_;
+    unsigned numSlots_;
+    /// Distance between slots in bytes.
+    unsigned slotStride_;
+    ObservationLayout layout_;
+    /// Number of observations published so far.
+    std::atomic<unsigned long long> numPublished_;
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared memory handshake requires lock-free 64-bit atomics");
+
+/// Ring of observations in named shared memory, written by one producer and read in place by local consumers.
+/// Each slot is guarded by sequence lock, so the producer never waits and consumers detect overwritten slots.
+class SharedObservationRing
+{
+public:
+    SharedObservationRing() = default;
+    ~SharedObservationRing() { Close(); }
+
+    SharedObservationRing(const SharedObservationRing&) = delete;
+    SharedObservationRing& operator=(const SharedObservationRing&) = delete;
+
+    /// Create shared memory block as producer.
+    bool Create(const ea::string& name, const ObservationLayout& layout, unsigned numSlots);
+    /// Open existing shared memory block as consumer.
+    bool Open(const ea::string& name);
+    /// Unmap shared memory. Producer also removes the name.
+    void Close();
+
+    bool IsOpen() const { return header_ != nullptr; }
+
+    const ObservationLayout& GetLayout() const { return header_->layout_; }
+
+    unsigned GetNumSlots() const { return header_->numSlots_; }
+
+    unsigned long long GetNumPublished() const { return header_->numPublished_.load(std::memory_order_acquire); }
+
+    /// Producer: begin writing next observation in place.
+    SharedObservationSlot& BeginWrite()
+    {
+        const unsigned long long index = header_->numPublished_.load(std::memory_order_relaxed);
+        SharedObservationSlot& slot = GetSlot(index);
+        slot.sequence_.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return slot;
+    }
+
+    /// Producer: publish observation started by BeginWrite.
+    void EndWrite()
+    {
+        const unsigned long long index = header_->numPublished_.load(std::memory_order_relaxed);
+        GetSlot(index).sequence_.store(2 * (index + 1), std::memory_order_release);
+        header_->numPublished_.store(index + 1, std::memory_order_release);
+    }
+
+    /// Consumer: begin reading observation in place. Return null if it is not published yet or already overwritten.
+    const SharedObservationSlot* BeginRead(unsigned long long index) const
+    {
+        const SharedObservationSlot& slot = GetSlot(index);
+        if (slot.sequence_.load(std::memory_order_acquire) != 2 * (index + 1))
+            return nullptr;
+        return &slot;
+    }
+
+    /// Consumer: check that observation was not overwritten while it was read.
+    bool EndRead(unsigned long long index) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return GetSlot(index).sequence_.load(std::memory_order_relaxed) == 2 * (index + 1);
+    }
+
+private:
+    SharedObservationSlot& GetSlot(unsigned long long index) const
+    {
+        const unsigned offset = static_cast<unsigned>(index % header_->numSlots_) * header_->slotStride_;
+        return *reinterpret_cast<SharedObservationSlot*>(reinterpret_cast<unsigned char*>(header_ + 1) + offset);
+    }
+
+    bool Map(const ea::string& name, unsigned size, bool create);
+
+    ea::string name_;
+    bool owner_{};
+    unsigned size_{};
+    void* handle_{};
+    SharedObservationHeader* header_{};
+};
+
+}
@@ -0,0 +1,252 @@
+#include "SimulationBatch.h"
+
+namespace Urho3D
+{
+
+SimulationBatch::SimulationBatch(int size, unsigned numSimulations, unsigned long long seed)
+    : size_(size)
+    , numSimulations_(numSimulations)
+    , numCells_(static_cast<unsigned>(size * size * size * size))
+    , numWords_((numCells_ + BitsPerWord - 1) / BitsPerWord)
+{
+    int stride = 1;
+    for (int axis = 0; axis < 4; ++axis)
+    {
+        directionOffsets_[MakeGridDirection(axis, -1)] = -stride;
+        directionOffsets_[MakeGridDirection(axis, 1)] = stride;
+        stride *= size_;
+    }
+
+    heads_.resize(numSimulations_);
+    headCells_.resize(numSimulations_);
+    tailCells_.resize(numSimulations_);
+    rotations_.resize(numSimulations_);
+    targets_.resize(numSimulations_);
+    lengths_.resize(numSimulations_);
+    pendingGrowth_.resize(numSimulations_);
+    gameOver_.resize(numSimulations_);
+    random_.resize(numSimulations_);
+    occupancy_.resize(numSimulations_ * numWords_);
+    links_.resize(numSimulations_ * numCells_);
+
+    ResetAll(seed);
+}
+
+void SimulationBatch::Reset(unsigned index, unsigned long long seed)
+{
+    ea::fill_n(occupancy_.begin() + index * numWords_, numWords_, 0u);
+    ea::fill_n(links_.begin() + index * numCells_, numCells_, static_cast<unsigned char>(0));
+    random_[index].SetSeed(seed);
+
+    // Same initial snake as GameSimulation::Reset, tail first
+    const GridDirection4D forward = MakeGridDirection(2, 1);
+    unsigned char* links = &links_[index * numCells_];
+    for (int i = 2; i >= 0; --i)
+    {
+        const unsigned cell = FlattenIndex({ size_ / 2, size_ / 2, size_ * 1 / 4 - i, size_ / 2 });
+        SetCell(index, cell);
+        if (i != 0)
+            links[cell] = forward + 1;
+        if (i == 2)
+            tailCells_[index] = cell;
+    }
+
+    heads_[index] = { size_ / 2, size_ / 2, size_ * 1 / 4, size_ / 2 };
+    headCells_[index] = FlattenIndex(heads_[index]);
+    rotations_[index] = IdentityGridRotation;
+    targets_[index] = { size_ / 2, size_ / 2, size_ * 3 / 4, size_ / 2 };
+    lengths_[index] = 3;
+    pendingGrowth_[index] = 0;
+    gameOver_[index] = false;
+}
+
+void SimulationBatch::ResetAll(unsigned long long seed)
+{
+    RandomGenerator seedGenerator(seed);
+    for (unsigned index = 0; index < numSimulations_; ++index)
+    {
+        const unsigned long long high = seedGenerator.Next();
+        Reset(index, (high << 32u) | seedGenerator.Next());
+    }
+}
+
+void SimulationBatch::Step(ea::span<const UserAction> actions)
+{
+    assert(actions.size() == numSimulations_);
+    StepRange(0, numSimulations_, actions);
+}
+
+void SimulationBatch::Step(ea::span<const UserAction> actions, WorkerPool& pool)
+{
+    assert(actions.size() == numSimulations_);
+
+    // Keep chunks large enough to avoid sharing cache lines of small per-simulation arrays
+    const unsigned chunkSize = 64;
+    pool.ParallelFor(numSimulations_, chunkSize,
+        [&](unsigned begin, unsigned end) { StepRange(begin, end, actions); });
+}
+
+void SimulationBatch::StepRange(unsigned begin, unsigned end, ea::span<const UserAction> actions)
+{
+    for (unsigned index = begin; index < end; ++index)
+        StepSimulation(index, actions[index]);
+}
+
+void SimulationBatch::StepSimulation(unsigned index, UserAction action)
+{
+    if (gameOver_[index])
+    {
+        if (autoReset_)
+        {
+            const unsigned long long high = random_[index].Next();
+            Reset(index, (high << 32u) | random_[index].Next());
+        }
+        return;
+    }
+
+    const GridDirection4D forward = MakeGridDirection(2, 1);
+    const IntVector4 head = heads_[index];
+
+    // If the action leads to immediate death, rollback it
+    GridRotationIndex rotation = ComposeRotations(rotations_[index], GetActionRotation(action).rotation_);
+    GridDirection4D heading = RotateDirection(rotation, forward);
+    if (IsOutside(head + DirectionToIntVector(heading)))
+    {
+        rotation = rotations_[index];
+        heading = RotateDirection(rotation, forward);
+    }
+    rotations_[index] = rotation;
+
+    const IntVector4 newHead = head + DirectionToIntVector(heading);
+    if (IsOutside(newHead))
+    {
+        gameOver_[index] = true;
+        return;
+    }
+
+    // Move head
+    unsigned char* links = &links_[index * numCells_];
+    const unsigned oldHeadCell = headCells_[index];
+    const unsigned newHeadCell = oldHeadCell + directionOffsets_[heading];
+    bool collision = TestCell(index, newHeadCell);
+    SetCell(index, newHeadCell);
+    links[oldHeadCell] = heading + 1;
+    heads_[index] = newHead;
+    headCells_[index] = newHeadCell;
+    ++lengths_[index];
+
+    if (newHead == targets_[index])
+    {
+        if (!SpawnTarget(index))
+        {
+            gameOver_[index] = true;
+            return;
+        }
+        pendingGrowth_[index] += lengthIncrement_;
+    }
+
+    // Remove tail segment if doesn't grow
+    if (pendingGrowth_[index] == 0)
+    {
+        const unsigned tailCell = tailCells_[index];
+        const GridDirection4D tailDirection = links[tailCell] - 1;
+        links[tailCell] = 0;
+        tailCells_[index] = tailCell + directionOffsets_[tailDirection];
+        --lengths_[index];
+
+        // Head may have just moved into the cell released by tail
+        if (tailCell != newHeadCell)
+            ClearCell(index, tailCell);
+        else
+            collision = false;
+    }
+    else
+        --pendingGrowth_[index];
+
+    if (collision)
+        gameOver_[index] = true;
+}
+
+bool SimulationBatch::SpawnTarget(unsigned index)
+{
+    const unsigned numFreeCells = numCells_ - lengths_[index];
+    if (numFreeCells == 0)
+        return false;
+
+    // Board is mostly empty, so rejection sampling usually succeeds in a few attempts
+    RandomGenerator& random = random_[index];
+    const unsigned maxAttempts = 8;
+    for (unsigned i = 0; i < maxAttempts; ++i)
+    {
+        const unsigned cell = random.Next(numCells_);
+        if (!TestCell(index, cell))
+        {
+            targets_[index] = UnflattenIndex(cell);
+            return true;
+        }
+    }
+
+    // Pick k-th free cell otherwise
+    unsigned freeCellIndex = random.Next(numFreeCells);
+    const unsigned* words = &occupancy_[index * numWords_];
+    for (unsigned wordIndex = 0; wordIndex < numWords_; ++wordIndex)
+    {
+        const unsigned firstCell = wordIndex * BitsPerWord;
+        const unsigned numValidBits = ea::min(BitsPerWord, numCells_ - firstCell);
+        const unsigned validMask = numValidBits == BitsPerWord ? M_MAX_UNSIGNED : (1u << numValidBits) - 1;
+        unsigned freeBits = ~words[wordIndex] & validMask;
+
+        const unsigned numFreeBits = CountSetBits(freeBits);
+        if (freeCellIndex >= numFreeBits)
+        {
+            freeCellIndex -= numFreeBits;
+            continue;
+        }
+
+        for (; freeCellIndex > 0; --freeCellIndex)
+            freeBits &= freeBits - 1;
+        const unsigned bit = CountSetBits((freeBits & (~freeBits + 1)) - 1);
+        targets_[index] = UnflattenIndex(firstCell + bit);
+        return true;
+    }
+
+    assert(0);
+    return false;
+}
+
+unsigned long long SimulationBatch::ComputeHash(unsigned index) const
+{
+    unsigned long long hash = 0;
+    const unsigned* words = &occupancy_[index * numWords_];
+    for (unsigned wordIndex = 0; wordIndex < numWords_; ++wordIndex)
+    {
+        // Visit snake cells only
+        unsigned word = words[wordIndex];
+        while (word != 0)
+        {
+            const unsigned bit = CountSetBits((word & (~word + 1)) - 1);
+            hash ^= GetZobristKey(ZobristFeature::SnakeCell, wordIndex * BitsPerWord + bit);
+            word &= word - 1;
+        }
+    }
+
+    hash ^= GetZobristKey(ZobristFeature::HeadCell, headCells_[index]);
+    hash ^= GetZobristKey(ZobristFeature::TargetCell, FlattenIndex(targets_[index]));
+    hash ^= GetZobristKey(ZobristFeature::Rotation, rotations_[index]);
+    hash ^= GetZobristKey(ZobristFeature::Growth, pendingGrowth_[index]);
+    return hash;
+}
+
+IntVector4 SimulationBatch::UnflattenIndex(unsigned cell) const
+{
+    const auto size = static_cast<unsigned>(size_);
+    IntVector4 pos;
+    for (int i = 0; i < 4; ++i)
+    {
+        pos[i] = static_cast<int>(cell % size);
+        cell /= size;
+    }
+    return pos;
+}
+
+}
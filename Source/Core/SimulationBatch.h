@@ -0,0 +1,127 @@
+#pragma once
+
+#include "GameSimulation.h"
+#include "RandomGenerator.h"
+#include "WorkerPool.h"
+
+#include <EASTL/span.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Many independent games advanced together, stored as structure of arrays.
+/// Rules match GameSimulation::Tick, except that targets are always random
+/// and cube frames used only for rendering are not tracked.
+class SimulationBatch
+{
+public:
+    SimulationBatch(int size, unsigned numSimulations, unsigned long long seed);
+
+    /// Reset single simulation to initial state.
+    void Reset(unsigned index, unsigned long long seed);
+
+    /// Reset all simulations. Simulation seeds are derived from the batch seed.
+    void ResetAll(unsigned long long seed);
+
+    /// Advance all simulations by one tick, one action per simulation.
+    void Step(ea::span<const UserAction> actions);
+
+    /// Advance all simulations by one tick, partitioned across pool threads.
+    void Step(ea::span<const UserAction> actions, WorkerPool& pool);
+
+    void SetLengthIncrement(unsigned lengthIncrement) { lengthIncrement_ = lengthIncrement; }
+
+    /// Whether finished simulations are reset on the next step with seed from their own generator.
+    void SetAutoReset(bool autoReset) { autoReset_ = autoReset; }
+
+    int GetSize() const { return size_; }
+
+    unsigned GetNumSimulations() const { return numSimulations_; }
+
+    const IntVector4& GetSnakeHead(unsigned index) const { return heads_[index]; }
+
+    GridRotationIndex GetRotation(unsigned index) const { return rotations_[index]; }
+
+    GridDirection4D GetHeading(unsigned index) const { return RotateDirection(rotations_[index], MakeGridDirection(2, 1)); }
+
+    const IntVector4& GetTargetPosition(unsigned index) const { return targets_[index]; }
+
+    unsigned GetSnakeLength(unsigned index) const { return lengths_[index]; }
+
+    bool IsGameOver(unsigned index) const { return !!gameOver_[index]; }
+
+    /// Calculate Zobrist hash of the simulation, equal to GameSimulation::GetHash of the same game.
+    /// Snake cells are read from the occupancy bitset, so it costs a walk over the board.
+    unsigned long long ComputeHash(unsigned index) const;
+
+    /// Return whether the cell is occupied by snake.
+    bool IsOccupied(unsigned index, const IntVector4& position) const
+    {
+        return IsOutside(position) || TestCell(index, FlattenIndex(position));
+    }
+
+    bool IsOutside(const IntVector4& position) const
+    {
+        const IntVector4 boxBegin{ 0, 0, 0, 0 };
+        const IntVector4 boxEnd{ size_, size_, size_, size_ };
+        return !IsInside(position, boxBegin, boxEnd);
+    }
+
+private:
+    static constexpr unsigned BitsPerWord = 32;
+
+    void StepRange(unsigned begin, unsigned end, ea::span<const UserAction> actions);
+    void StepSimulation(unsigned index, UserAction action);
+    bool SpawnTarget(unsigned index);
+
+    unsigned FlattenIndex(const IntVector4& pos) const
+    {
+        return static_cast<unsigned>(((pos[3] * size_ + pos[2]) * size_ + pos[1]) * size_ + pos[0]);
+    }
+
+    IntVector4 UnflattenIndex(unsigned cell) const;
+
+    bool TestCell(unsigned index, unsigned cell) const
+    {
+        return !!(occupancy_[index * numWords_ + cell / BitsPerWord] & (1u << (cell % BitsPerWord)));
+    }
+
+    void SetCell(unsigned index, unsigned cell)
+    {
+        occupancy_[index * numWords_ + cell / BitsPerWord] |= 1u << (cell % BitsPerWord);
+    }
+
+    void ClearCell(unsigned index, unsigned cell)
+    {
+        occupancy_[index * numWords_ + cell / BitsPerWord] &= ~(1u << (cell % BitsPerWord));
+    }
+
+    int size_{};
+    unsigned numSimulations_{};
+    unsigned numCells_{};
+    unsigned numWords_{};
+    /// Offset of flattened cell index for each direction.
+    int directionOffsets_[NumGridDirections]{};
+
+    unsigned lengthIncrement_{ 3 };
+    bool autoReset_{};
+
+    ea::vector<IntVector4> heads_;
+    ea::vector<unsigned> headCells_;
+    ea::vector<unsigned> tailCells_;
+    ea::vector<GridRotationIndex> rotations_;
+    ea::vector<IntVector4> targets_;
+    ea::vector<unsigned> lengths_;
+    ea::vector<unsigned> pendingGrowth_;
+    ea::vector<unsigned char> gameOver_;
+    ea::vector<RandomGenerator> random_;
+
+    /// Occupancy bitset of each simulation, numWords_ words per simulation.
+    ea::vector<unsigned> occupancy_;
+    /// Direction from each snake cell to the next cell towards the head plus one, zero for head and free cells.
+    /// numCells_ elements per simulation.
+    ea::vector<unsigned char> links_;
+};
+
+}
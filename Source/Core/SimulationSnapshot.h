@@ -0,0 +1,97 @@
+#pragma once
+
+#include "GameSimulation.h"
+
+namespace Urho3D
+{
+
+/// Copy of simulation state needed to present the last tick.
+/// Snake and camera keep both previous and current state, so the tick is animated without the simulation.
+class SimulationSnapshot
+{
+public:
+    /// Copy state of the simulation. Storage is reused, so updates stop allocating once the snake stops growing.
+    /// Snake is copied incrementally and topology is copied only when changed, so update cost doesn't depend on snake length.
+    void Update(const GameSimulation& sim, unsigned long long numTicks)
+    {
+        numTicks_ = numTicks;
+        size_ = sim.GetSize();
+        if (topology_.GetSize() != sim.GetTopology().GetSize() || topology_.IsWrapAround() != sim.GetTopology().IsWrapAround())
+            topology_ = sim.GetTopology();
+        animationSettings_ = sim.GetAnimationSettings();
+        camera_ = sim.GetCamera();
+        snake_.CopyFrom(sim.GetSnake());
+        targetPositions_.assign(sim.GetTargetPositions().begin(), sim.GetTargetPositions().end());
+        targetPosition_ = sim.GetTargetPosition();
+        const ea::span<const IntVector4> path = sim.GetPath();
+        path_.assign(path.begin(), path.end());
+        obstacles_ = sim.GetObstacles();
+        nextAction_ = sim.GetNextAction();
+        bestAction_ = sim.GetBestAction();
+        gameOver_ = sim.IsGameOver();
+        deathAnimation_ = sim.HasDeathAnimation();
+    }
+
+    /// Return number of ticks simulated before the snapshot was taken.
+    unsigned long long GetNumTicks() const { return numTicks_; }
+
+    int GetSize() const { return size_; }
+
+    const GridTopology4D& GetTopology() const { return topology_; }
+
+    bool IsOutside(const IntVector4& position) const { return topology_.IsOutside(position); }
+
+    const AnimationSettings& GetAnimationSettings() const { return animationSettings_; }
+
+    const GridCamera4D& GetCamera() const { return camera_; }
+
+    const SnakeBody& GetSnake() const { return snake_; }
+
+    unsigned GetSnakeLength() const { return snake_.Size(); }
+
+    IntVector4 GetSnakeHead() const { return snake_.Front().position_; }
+
+    const ea::vector<IntVector4>& GetTargetPositions() const { return targetPositions_; }
+
+    const IntVector4& GetTargetPosition() const { return targetPosition_; }
+
+    ea::span<const IntVector4> GetPath() const { return path_; }
+
+    const GridObstacleSet4D& GetObstacles() const { return obstacles_; }
+
+    UserAction GetNextAction() const { return nextAction_; }
+
+    UserAction GetBestAction() const { return bestAction_; }
+
+    bool IsGameOver() const { return gameOver_; }
+
+    bool HasDeathAnimation() const { return deathAnimation_; }
+
+    bool IsValidHeadPosition(const IntVector4& position) const
+    {
+        return Urho3D::IsValidHeadPosition(topology_, obstacles_, snake_, position);
+    }
+
+    CurrentAnimationType GetCurrentAnimationType(float blendFactor) const
+    {
+        return Urho3D::GetCurrentAnimationType(camera_, animationSettings_, blendFactor);
+    }
+
+private:
+    unsigned long long numTicks_{};
+    int size_{};
+    GridTopology4D topology_;
+    AnimationSettings animationSettings_;
+    GridCamera4D camera_;
+    SnakeBody snake_;
+    ea::vector<IntVector4> targetPositions_;
+    IntVector4 targetPosition_{};
+    ea::vector<IntVector4> path_;
+    GridObstacleSet4D obstacles_;
+    UserAction nextAction_{};
+    UserAction bestAction_{};
+    bool gameOver_{};
+    bool deathAnimation_{};
+};
+
+}
@@ -0,0 +1,316 @@
+#include "SnakeArena.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Number of random attempts to find room for the initial snake.
+const unsigned maxSpawnAttempts = 16;
+
+}
+
+SnakeArena::SnakeArena(int size, unsigned numSnakes, unsigned numTargets, unsigned long long seed)
+    : size_(size)
+    , topology_(size)
+    , numTargets_(numTargets)
+    , freeCells_(size)
+{
+    assert(numSnakes < ea::numeric_limits<unsigned short>::max());
+
+    for (unsigned i = 0; i < numSnakes; ++i)
+        snakes_.emplace_back(size_);
+
+    Reset(seed);
+}
+
+void SnakeArena::Reset(unsigned long long seed)
+{
+    random_.SetSeed(seed);
+    numTicks_ = 0;
+
+    owners_.Clear();
+    freeCells_.Reset(size_);
+
+    for (Snake& snake : snakes_)
+    {
+        snake.body_.clear();
+        snake.alive_ = false;
+        snake.numDeaths_ = 0;
+    }
+
+    targets_.clear();
+    while (targets_.size() < numTargets_)
+    {
+        const auto position = freeCells_.GetRandomCellExcept(random_, targets_);
+        if (!position.second)
+            break;
+        targets_.push_back(position.first);
+    }
+
+    for (unsigned i = 0; i < snakes_.size(); ++i)
+        SpawnSnake(i);
+}
+
+void SnakeArena::SetWrapAround(bool wrapAround)
+{
+    topology_.Reset(size_, wrapAround);
+    for (Snake& snake : snakes_)
+        snake.pathFinder_.SetTopology(topology_);
+}
+
+void SnakeArena::Tick()
+{
+    for (unsigned i = 0; i < snakes_.size(); ++i)
+    {
+        if (!snakes_[i].alive_)
+            SpawnSnake(i);
+    }
+
+    for (unsigned i = 0; i < snakes_.size(); ++i)
+        ChooseMove(i);
+
+    ResolveMoves();
+    ++numTicks_;
+}
+
+void SnakeArena::Tick(WorkerPool& pool)
+{
+    for (unsigned i = 0; i < snakes_.size(); ++i)
+    {
+        if (!snakes_[i].alive_)
+            SpawnSnake(i);
+    }
+
+    // Board is not modified until all moves are chosen
+    pool.ParallelFor(snakes_.size(), 1, [this](unsigned begin, unsigned end)
+    {
+        for (unsigned i = begin; i < end; ++i)
+            ChooseMove(i);
+    });
+
+    ResolveMoves();
+    ++numTicks_;
+}
+
+void SnakeArena::SpawnSnake(unsigned index)
+{
+    Snake& snake = snakes_[index];
+    snake.body_.clear();
+
+    // Snake is laid behind the head like in the game, crowded board may have no room for it until later ticks
+    for (unsigned attempt = 0; attempt < maxSpawnAttempts && snake.body_.size() < InitialLength; ++attempt)
+    {
+        const auto headPosition = freeCells_.GetRandomCellExcept(random_, targets_);
+        if (!headPosition.second)
+            return;
+
+        snake.heading_ = static_cast<GridDirection4D>(random_.Next(NumGridDirections));
+        const IntVector4& backward = DirectionToIntVector(ReverseDirection(snake.heading_));
+
+        snake.body_.clear();
+        snake.body_.push_back(headPosition.first);
+        while (snake.body_.size() < InitialLength)
+        {
+            const IntVector4 position = topology_.Step(snake.body_.back(), backward);
+            if (!IsFree(position) || IsTarget(position) || ea::find(snake.body_.begin(), snake.body_.end(), position) != snake.body_.end())
+                break;
+            snake.body_.push_back(position);
+        }
+    }
+
+    if (snake.body_.size() < InitialLength)
+    {
+        snake.body_.clear();
+        return;
+    }
+
+    snake.pendingGrowth_ = 0;
+    snake.alive_ = true;
+    snake.pathFinder_.ClearPath();
+    for (const IntVector4& position : snake.body_)
+        Occupy(position, index);
+}
+
+void SnakeArena::SpawnTarget(unsigned targetIndex)
+{
+    const auto position = freeCells_.GetRandomCellExcept(random_, targets_);
+    if (position.second)
+        targets_[targetIndex] = position.first;
+    else
+        targets_.erase(targets_.begin() + targetIndex);
+}
+
+void SnakeArena::ChooseMove(unsigned index)
+{
+    Snake& snake = snakes_[index];
+    if (!snake.alive_)
+        return;
+
+    const IntVector4 headPosition = snake.body_.front();
+    const IntVector4& headingVector = DirectionToIntVector(snake.heading_);
+
+    // Go to the nearest target
+    bool found = false;
+    if (!targets_.empty())
+    {
+        const IntVector4* targetPosition = &targets_[0];
+        for (const IntVector4& position : targets_)
+        {
+            if (topology_.GetDistance(headPosition, position) < topology_.GetDistance(headPosition, *targetPosition))
+                targetPosition = &position;
+        }
+
+        const auto checkCell = [this](const IntVector4& position) { return IsFree(position); };
+        found = snake.pathFinder_.UpdatePath(headPosition, headingVector, *targetPosition, checkCell);
+
+        // Cached path may be blocked by other snakes
+        if (found && !IsFree(topology_.Step(headPosition, snake.pathFinder_.GetNextCellOffset())))
+        {
+            snake.pathFinder_.ClearPath();
+            found = snake.pathFinder_.UpdatePath(headPosition, headingVector, *targetPosition, checkCell);
+        }
+
+        found = found && snake.pathFinder_.GetNextCellOffset() != IntVector4{};
+    }
+
+    if (found)
+    {
+        snake.nextPosition_ = topology_.Step(headPosition, snake.pathFinder_.GetNextCellOffset());
+        return;
+    }
+
+    // Keep heading or turn into any free cell
+    snake.nextPosition_ = topology_.Step(headPosition, headingVector);
+    if (IsFree(snake.nextPosition_))
+        return;
+
+    for (unsigned i = 0; i < NumGridDirections; ++i)
+    {
+        const IntVector4 position = topology_.Step(headPosition, DirectionToIntVector(static_cast<GridDirection4D>(i)));
+        if (i != ReverseDirection(snake.heading_) && IsFree(position))
+        {
+            snake.nextPosition_ = position;
+            return;
+        }
+    }
+}
+
+void SnakeArena::ResolveMoves()
+{
+    const auto isTailReleased = [this](const Snake& snake)
+    {
+        return snake.pendingGrowth_ == 0 && !IsTarget(snake.nextPosition_);
+    };
+
+    // Heads may enter free cells and tail cells that are released on this tick
+    claimOrder_.clear();
+    for (unsigned i = 0; i < snakes_.size(); ++i)
+    {
+        Snake& snake = snakes_[i];
+        if (!snake.alive_)
+            continue;
+
+        snake.dies_ = false;
+        if (IsOutside(snake.nextPosition_))
+        {
+            snake.dies_ = true;
+            continue;
+        }
+
+        const unsigned owner = owners_.Get(snake.nextPosition_);
+        if (owner != 0)
+        {
+            const Snake& ownerSnake = snakes_[owner - 1];
+            snake.dies_ = snake.nextPosition_ != ownerSnake.body_.back() || !isTailReleased(ownerSnake);
+        }
+
+        if (!snake.dies_)
+            claimOrder_.push_back(i);
+    }
+
+    // From heads entering the same cell only the longest survives, lower index wins ties
+    ea::sort(claimOrder_.begin(), claimOrder_.end(), [this](unsigned lhs, unsigned rhs)
+    {
+        const unsigned long long lhsCell = FlattenGridIndex(snakes_[lhs].nextPosition_, size_);
+        const unsigned long long rhsCell = FlattenGridIndex(snakes_[rhs].nextPosition_, size_);
+        if (lhsCell != rhsCell)
+            return lhsCell < rhsCell;
+        if (snakes_[lhs].body_.size() != snakes_[rhs].body_.size())
+            return snakes_[lhs].body_.size() > snakes_[rhs].body_.size();
+        return lhs < rhs;
+    });
+    for (unsigned i = 1; i < claimOrder_.size(); ++i)
+    {
+        Snake& snake = snakes_[claimOrder_[i]];
+        if (snake.nextPosition_ == snakes_[claimOrder_[i - 1]].nextPosition_)
+            snake.dies_ = true;
+    }
+
+    // Release cells of dead snakes and released tails first, so heads can enter them
+    for (Snake& snake : snakes_)
+    {
+        if (!snake.alive_)
+            continue;
+
+        if (snake.dies_)
+        {
+            for (const IntVector4& position : snake.body_)
+                Release(position);
+            snake.body_.clear();
+            snake.alive_ = false;
+            ++snake.numDeaths_;
+        }
+        else
+        {
+            snake.heading_ = IntVectorToDirection(topology_.GetDelta(snake.body_.front(), snake.nextPosition_));
+            if (isTailReleased(snake))
+            {
+                Release(snake.body_.back());
+                snake.body_.pop_back();
+            }
+        }
+    }
+
+    // Targets are respawned after all heads are placed
+    eatenTargets_.clear();
+
+    for (unsigned i = 0; i < snakes_.size(); ++i)
+    {
+        Snake& snake = snakes_[i];
+        if (!snake.alive_)
+            continue;
+
+        snake.body_.push_front(snake.nextPosition_);
+        Occupy(snake.nextPosition_, i);
+
+        const auto targetIter = ea::find(targets_.begin(), targets_.end(), snake.nextPosition_);
+        if (targetIter != targets_.end())
+        {
+            snake.pendingGrowth_ += lengthIncrement_ - 1;
+            eatenTargets_.push_back(targetIter - targets_.begin());
+        }
+        else if (snake.pendingGrowth_ > 0)
+            --snake.pendingGrowth_;
+    }
+
+    // Targets without room are removed, later indices go first
+    ea::sort(eatenTargets_.begin(), eatenTargets_.end(), [](unsigned lhs, unsigned rhs) { return lhs > rhs; });
+    for (unsigned targetIndex : eatenTargets_)
+        SpawnTarget(targetIndex);
+}
+
+void SnakeArena::Occupy(const IntVector4& position, unsigned index)
+{
+    owners_.Set(position, static_cast<unsigned short>(index + 1));
+    freeCells_.Remove(position);
+}
+
+void SnakeArena::Release(const IntVector4& position)
+{
+    owners_.Set(position, 0);
+    freeCells_.Insert(position);
+}
+
+}
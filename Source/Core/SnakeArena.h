@@ -0,0 +1,127 @@
+#pragma once
+
+#include "GridChunkedArray4D.h"
+#include "GridFreeCellSet4D.h"
+#include "GridPathFinder4D.h"
+#include "GridRotation4D.h"
+#include "GridTopology4D.h"
+#include "RandomGenerator.h"
+#include "WorkerPool.h"
+
+#include <EASTL/deque.h>
+#include <EASTL/numeric_limits.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Many AI snakes on one board with shared occupancy.
+/// Every tick each snake finds its path in parallel over the unchanged board,
+/// then moves are applied serially in snake order, so the result does not depend on the number of threads.
+/// Snakes follow the rules of GameSimulation: snake starts with three cells laid behind the head,
+/// grows while eating targets and dies when its head enters occupied cell that is not released by a tail on this tick.
+/// From heads entering the same cell only the longest snake survives.
+/// Dead snakes release their cells and respawn on the next tick.
+class SnakeArena
+{
+public:
+    SnakeArena(int size, unsigned numSnakes, unsigned numTargets, unsigned long long seed);
+
+    /// Respawn all snakes and targets.
+    void Reset(unsigned long long seed);
+
+    /// Set whether coordinates wrap around board edges, so there are no walls. Call before reset.
+    void SetWrapAround(bool wrapAround);
+
+    /// Advance all snakes by one tick on calling thread.
+    void Tick();
+
+    /// Advance all snakes by one tick, path finding is spread across pool threads.
+    void Tick(WorkerPool& pool);
+
+    void SetLengthIncrement(unsigned lengthIncrement) { lengthIncrement_ = lengthIncrement; }
+
+    int GetSize() const { return size_; }
+
+    unsigned GetNumSnakes() const { return snakes_.size(); }
+
+    unsigned GetNumTicks() const { return numTicks_; }
+
+    bool IsAlive(unsigned index) const { return snakes_[index].alive_; }
+
+    unsigned GetSnakeLength(unsigned index) const { return snakes_[index].body_.size(); }
+
+    const IntVector4& GetSnakeHead(unsigned index) const { return snakes_[index].body_.front(); }
+
+    /// Return cells of the snake from head to tail.
+    const ea::deque<IntVector4>& GetSnakeBody(unsigned index) const { return snakes_[index].body_; }
+
+    GridDirection4D GetSnakeHeading(unsigned index) const { return snakes_[index].heading_; }
+
+    /// Return cell the head entered on the last tick, or tried to enter if the snake died.
+    const IntVector4& GetLastMove(unsigned index) const { return snakes_[index].nextPosition_; }
+
+    unsigned GetNumDeaths(unsigned index) const { return snakes_[index].numDeaths_; }
+
+    const ea::vector<IntVector4>& GetTargets() const { return targets_; }
+
+    /// Return index of the snake that occupies the cell plus one, zero if the cell is free.
+    unsigned GetOwner(const IntVector4& position) const { return owners_.Get(position); }
+
+    const GridTopology4D& GetTopology() const { return topology_; }
+
+    /// Return whether the cell is outside of the board, never true on wrapped board.
+    bool IsOutside(const IntVector4& position) const { return topology_.IsOutside(position); }
+
+private:
+    static const unsigned InitialLength = 3;
+
+    struct Snake
+    {
+        explicit Snake(int size) : pathFinder_(size) {}
+
+        /// Cells from head to tail.
+        ea::deque<IntVector4> body_;
+        GridDirection4D heading_{};
+        unsigned pendingGrowth_{};
+        bool alive_{};
+        unsigned numDeaths_{};
+        GridPathFinder4D pathFinder_;
+
+        /// Move chosen for the current tick.
+        IntVector4 nextPosition_{};
+        bool dies_{};
+    };
+
+    /// Called from many threads while moves are chosen.
+    bool IsFree(const IntVector4& position) const { return !IsOutside(position) && owners_.GetConcurrent(position) == 0; }
+
+    bool IsTarget(const IntVector4& position) const { return ea::find(targets_.begin(), targets_.end(), position) != targets_.end(); }
+
+    void SpawnSnake(unsigned index);
+    /// Spawn target on free cell that is not a target. Target is removed if there is no room.
+    void SpawnTarget(unsigned targetIndex);
+    void ChooseMove(unsigned index);
+    void ResolveMoves();
+    void Occupy(const IntVector4& position, unsigned index);
+    void Release(const IntVector4& position);
+
+    int size_{};
+    GridTopology4D topology_;
+    unsigned numTargets_{};
+    unsigned lengthIncrement_{ 3 };
+    unsigned numTicks_{};
+    RandomGenerator random_;
+
+    ea::vector<Snake> snakes_;
+    ea::vector<IntVector4> targets_;
+
+    /// Snake index plus one for each cell, zero for free cells. Bricks are allocated where snakes have been.
+    GridChunkedArray4D<unsigned short> owners_;
+    GridFreeCellSet4D freeCells_;
+    /// Snake indices ordered by claimed cell, used to resolve head collisions.
+    ea::vector<unsigned> claimOrder_;
+    ea::vector<unsigned> eatenTargets_;
+};
+
+}
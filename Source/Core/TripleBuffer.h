@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+/// Lock-free triple buffer for one producer thread and one consumer thread.
+/// Producer writes into its own buffer and publishes it, consumer reads the latest published buffer.
+/// Neither side ever waits, intermediate values are dropped if the consumer is slow.
+template <class T>
+class TripleBuffer
+{
+public:
+    /// Return buffer owned by producer.
+    T& GetWriteBuffer() { return buffers_[writeIndex_]; }
+
+    /// Publish buffer owned by producer. Producer gets another buffer, which keeps one of older values.
+    void Publish()
+    {
+        const unsigned previous = sharedIndex_.exchange(writeIndex_ | NewValueFlag, std::memory_order_acq_rel);
+        writeIndex_ = previous & IndexMask;
+    }
+
+    /// Take the latest published buffer for reading. Return false if nothing is published since last call.
+    bool Update()
+    {
+        if (!(sharedIndex_.load(std::memory_order_relaxed) & NewValueFlag))
+            return false;
+
+        const unsigned previous = sharedIndex_.exchange(readIndex_, std::memory_order_acq_rel);
+        readIndex_ = previous & IndexMask;
+        return true;
+    }
+
+    /// Return buffer owned by consumer.
+    const T& GetReadBuffer() const { return buffers_[readIndex_]; }
+
+private:
+    static const unsigned IndexMask = 3;
+    static const unsigned NewValueFlag = 4;
+
+    T buffers_[3];
+    unsigned writeIndex_{ 0 };
+    /// Buffer that is neither written nor read, with flag set if it is published and not taken yet.
+    std::atomic<unsigned> sharedIndex_{ 1 };
+    unsigned readIndex_{ 2 };
+};
+
+}
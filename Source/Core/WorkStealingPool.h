@@ -0,0 +1,166 @@
+#pragma once
+
+#include <EASTL/deque.h>
+#include <EASTL/functional.h>
+#include <EASTL/unique_ptr.h>
+#include <EASTL/vector.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Urho3D
+{
+
+/// Thread pool where each thread owns a task queue.
+/// Threads run their own tasks in submission order and steal the newest tasks of other threads when idle.
+/// Tasks may submit more tasks, which go to the queue of the current thread.
+/// Pool with zero workers runs all tasks in Wait. Builds without threads (SNAKE4D_NO_THREADS) never start workers.
+class WorkStealingPool
+{
+public:
+    using Task = ea::function<void()>;
+
+    explicit WorkStealingPool(unsigned numWorkers = 0)
+    {
+#ifdef SNAKE4D_NO_THREADS
+        numWorkers = 0;
+#endif
+        // Last queue belongs to external threads
+        for (unsigned i = 0; i < numWorkers + 1; ++i)
+            queues_.push_back(ea::make_unique<TaskQueue>());
+        for (unsigned i = 0; i < numWorkers; ++i)
+            workers_.push_back(std::thread([this, i] { WorkerLoop(i); }));
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            shutdown_ = true;
+        }
+        wakeCondition_.notify_all();
+        for (std::thread& worker : workers_)
+            worker.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned GetNumThreads() const { return workers_.size() + 1; }
+
+    /// Add task to the queue of current thread.
+    void Submit(Task task)
+    {
+        numPendingTasks_.fetch_add(1, std::memory_order_relaxed);
+
+        TaskQueue& queue = *queues_[GetCurrentQueueIndex()];
+        {
+            // Count the task before anyone can pop it
+            std::lock_guard<std::mutex> wakeLock(wakeMutex_);
+            std::lock_guard<std::mutex> queueLock(queue.mutex_);
+            queue.tasks_.push_back(ea::move(task));
+            ++numQueuedTasks_;
+        }
+        wakeCondition_.notify_one();
+    }
+
+    /// Execute tasks on calling thread until all submitted tasks are completed.
+    void Wait()
+    {
+        const unsigned queueIndex = GetCurrentQueueIndex();
+        while (numPendingTasks_.load(std::memory_order_acquire) != 0)
+        {
+            if (!TryRunTask(queueIndex))
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    struct TaskQueue
+    {
+        std::mutex mutex_;
+        ea::deque<Task> tasks_;
+    };
+
+    unsigned GetCurrentQueueIndex() const
+    {
+        return currentPool == this ? currentQueueIndex : queues_.size() - 1;
+    }
+
+    bool TryPopTask(unsigned queueIndex, bool steal, Task& task)
+    {
+        TaskQueue& queue = *queues_[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex_);
+        if (queue.tasks_.empty())
+            return false;
+
+        if (steal)
+        {
+            task = ea::move(queue.tasks_.back());
+            queue.tasks_.pop_back();
+        }
+        else
+        {
+            task = ea::move(queue.tasks_.front());
+            queue.tasks_.pop_front();
+        }
+        return true;
+    }
+
+    bool TryRunTask(unsigned queueIndex)
+    {
+        Task task;
+        bool found = TryPopTask(queueIndex, false, task);
+        for (unsigned i = 1; !found && i < queues_.size(); ++i)
+            found = TryPopTask((queueIndex + i) % queues_.size(), true, task);
+        if (!found)
+            return false;
+
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            --numQueuedTasks_;
+        }
+
+        task();
+        numPendingTasks_.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    void WorkerLoop(unsigned queueIndex)
+    {
+        currentPool = this;
+        currentQueueIndex = queueIndex;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex_);
+                wakeCondition_.wait(lock, [this] { return shutdown_ || numQueuedTasks_ != 0; });
+                if (shutdown_)
+                    return;
+            }
+
+            while (TryRunTask(queueIndex))
+                ;
+        }
+    }
+
+    /// Pool and queue of current worker thread.
+    static inline thread_local const WorkStealingPool* currentPool{};
+    static inline thread_local unsigned currentQueueIndex{};
+
+    ea::vector<ea::unique_ptr<TaskQueue>> queues_;
+    ea::vector<std::thread> workers_;
+
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCondition_;
+    bool shutdown_{};
+    /// Number of tasks in queues, guarded by wakeMutex_.
+    unsigned numQueuedTasks_{};
+    /// Number of submitted tasks that are not completed yet.
+    std::atomic<unsigned> numPendingTasks_{};
+};
+
+}
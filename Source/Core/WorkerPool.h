@@ -0,0 +1,131 @@
+#pragma once
+
+#include <EASTL/algorithm.h>
+#include <EASTL/functional.h>
+#include <EASTL/vector.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Urho3D
+{
+
+/// Fixed set of worker threads that execute blocking parallel loops.
+/// Calling thread participates in the work, so pool with zero workers runs everything inline.
+/// Builds without threads (SNAKE4D_NO_THREADS) never start workers.
+class WorkerPool
+{
+public:
+    using RangeCallback = ea::function<void(unsigned begin, unsigned end)>;
+
+    explicit WorkerPool(unsigned numWorkers = 0)
+    {
+#ifdef SNAKE4D_NO_THREADS
+        numWorkers = 0;
+#endif
+        for (unsigned i = 0; i < numWorkers; ++i)
+            workers_.push_back(std::thread([this] { WorkerLoop(); }));
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shutdown_ = true;
+        }
+        wakeCondition_.notify_all();
+        for (std::thread& worker : workers_)
+            worker.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned GetNumThreads() const { return workers_.size() + 1; }
+
+    /// Split [0, count) into chunks of at most chunkSize elements and process them on all threads.
+    /// Returns when all chunks are processed.
+    void ParallelFor(unsigned count, unsigned chunkSize, const RangeCallback& callback)
+    {
+        if (count == 0)
+            return;
+
+        chunkSize = ea::max(1u, chunkSize);
+        if (workers_.empty() || count <= chunkSize)
+        {
+            callback(0, count);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            callback_ = &callback;
+            count_ = count;
+            chunkSize_ = chunkSize;
+            nextElement_ = 0;
+            numBusyWorkers_ = workers_.size();
+            ++generation_;
+        }
+        wakeCondition_.notify_all();
+
+        ProcessChunks();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCondition_.wait(lock, [this] { return numBusyWorkers_ == 0; });
+        callback_ = nullptr;
+    }
+
+private:
+    void ProcessChunks()
+    {
+        while (true)
+        {
+            const unsigned begin = nextElement_.fetch_add(chunkSize_, std::memory_order_relaxed);
+            if (begin >= count_)
+                break;
+            (*callback_)(begin, ea::min(begin + chunkSize_, count_));
+        }
+    }
+
+    void WorkerLoop()
+    {
+        unsigned lastGeneration = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeCondition_.wait(lock, [&] { return shutdown_ || generation_ != lastGeneration; });
+                if (shutdown_)
+                    return;
+                lastGeneration = generation_;
+            }
+
+            ProcessChunks();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --numBusyWorkers_;
+            }
+            doneCondition_.notify_one();
+        }
+    }
+
+    ea::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable wakeCondition_;
+    std::condition_variable doneCondition_;
+    bool shutdown_{};
+    unsigned generation_{};
+    unsigned numBusyWorkers_{};
+
+    /// Current loop, valid while ParallelFor is running.
+    const RangeCallback* callback_{};
+    unsigned count_{};
+    unsigned chunkSize_{};
+    std::atomic<unsigned> nextElement_{};
+};
+
+}
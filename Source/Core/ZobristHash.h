@@ -0,0 +1,92 @@
+#pragma once
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Kind of state feature that has its own set of Zobrist keys.
+enum class ZobristFeature : unsigned
+{
+    SnakeCell,
+    HeadCell,
+    TargetCell,
+    Rotation,
+    Growth,
+    Settings
+};
+
+/// Return pseudo-random key of state feature with given index.
+/// Keys are computed on the fly with SplitMix64 finalizer, so no key tables are stored.
+/// Indices of cells of large boards may exceed 32 bits, their high bits are mixed in separately,
+/// so keys of smaller indices are unchanged.
+inline unsigned long long GetZobristKey(ZobristFeature feature, unsigned long long index)
+{
+    unsigned long long x = (static_cast<unsigned long long>(feature) << 32 | (index & 0xffffffffull)) + 0x9e3779b97f4a7c15ull;
+    x ^= (index >> 32) * 0xd6e8feb86659fd93ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/// Direct-mapped cache of values keyed by 64-bit state hash. Colliding entries replace each other.
+/// Not thread-safe.
+template <class T>
+class TranspositionCache
+{
+public:
+    explicit TranspositionCache(unsigned sizeLog2 = 16)
+        : entries_(1u << sizeLog2)
+        , mask_((1u << sizeLog2) - 1)
+    {
+    }
+
+    bool Find(unsigned long long hash, T& value)
+    {
+        const Entry& entry = entries_[static_cast<unsigned>(hash) & mask_];
+        if (!entry.valid_ || entry.hash_ != hash)
+        {
+            ++numMisses_;
+            return false;
+        }
+
+        ++numHits_;
+        value = entry.value_;
+        return true;
+    }
+
+    void Store(unsigned long long hash, const T& value)
+    {
+        Entry& entry = entries_[static_cast<unsigned>(hash) & mask_];
+        entry.hash_ = hash;
+        entry.value_ = value;
+        entry.valid_ = true;
+    }
+
+    void Clear()
+    {
+        for (Entry& entry : entries_)
+            entry.valid_ = false;
+        numHits_ = 0;
+        numMisses_ = 0;
+    }
+
+    unsigned long long GetNumHits() const { return numHits_; }
+
+    unsigned long long GetNumMisses() const { return numMisses_; }
+
+private:
+    struct Entry
+    {
+        unsigned long long hash_{};
+        T value_{};
+        bool valid_{};
+    };
+
+    ea::vector<Entry> entries_;
+    unsigned mask_{};
+    unsigned long long numHits_{};
+    unsigned long long numMisses_{};
+};
+
+}
@@ -1,9 +1,19 @@
+#include "AsyncActionPlanner.h"
+#include "GameReplay.h"
 #include "GeometryBuilder.h"
-#include "GameSimulation.h"
+#include "MonteCarloPlanner.h"
+#include "SimulationRenderer.h"
+#include "TripleBuffer.h"
 
 #include <Urho3D/Urho3DAll.h>
 #include <RmlUi/Core/DataModelHandle.h>
 
+#include <EASTL/deque.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 using namespace Urho3D;
 
 static const IntVector4 standardTargets[] = {
@@ -29,6 +39,15 @@ static const IntVector4 tutorialTargets[] = {
 
 static const unsigned numScoreDigits = 8;
 
+/// Number of ticks skipped at once during replay playback.
+static const unsigned replaySkipTicks = 100;
+/// Speed of replay playback while fast forward is held.
+static const float replayFastForwardSpeed = 8.0f;
+/// Number of ticks that can be rewound in tutorial.
+static const unsigned tutorialRewindCapacity = 64;
+/// Number of ticks rewound at once in tutorial.
+static const unsigned tutorialRewindTicks = 4;
+
 static const Color tutorialHintSpaceHighlightColor{ 0.0f, 1.0f, 0.0f, 1.0f };
 static const Color tutorialHintRedHighlightColor{ 1.0f, 0.3f, 0.3f, 1.0f };
 static const Color tutorialHintBlueHighlightColor{ 0.6f, 0.6f, 1.0f, 1.0f };
@@ -108,15 +127,28 @@ ea::string FormatScore(const ea::string& intro, unsigned score)
     return Format("{}: {:{}}", intro, score, numScoreDigits);
 }
 
+/// Return file name of the replay of the last game played by the player.
+ea::string GetReplayFileName(Context* context)
+{
+    auto fileSystem = context->GetSubsystem<FileSystem>();
+    return fileSystem->GetAppPreferencesDir("rbfx", "Snake4D") + "LastReplay.bin";
+}
+
+/// Game session simulates ticks on dedicated thread owned by SimulationThread, so slow planning never stalls the frame.
+/// Main thread accumulates time, sends user actions and presents the latest published snapshot.
+/// Builds without threads (SNAKE4D_NO_THREADS) execute queued commands on main thread at the end of each update.
 class GameSession : public Object
 {
     URHO3D_OBJECT(GameSession, Object);
 
+    friend class SimulationThread;
+
 public:
     GameSession(Context* context)
         : Object(context)
+        , replayFileName_(GetReplayFileName(context))
     {
-        sim_.Reset(standardTargets);
+        sim_.Reset(standardTargets, static_cast<unsigned long long>(time(0)));
     }
 
     virtual bool IsTutorialHintVisible() { return false; };
@@ -133,23 +165,44 @@ public:
 
     virtual bool IsSmoothRotation() { return false; }
 
-    unsigned GetScore() const { return sim_.GetSnakeLength(); }
+    unsigned GetScore() const { return GetSnapshot().GetSnakeLength(); }
 
-    float GetLogicInterpolationFactor() const { return logicTimeAccumulator_ / updatePeriod_; }
+    float GetLogicInterpolationFactor() const
+    {
+        // Animation of the last simulated tick is complete while requested tick is being simulated
+        if (GetSnapshot().GetNumTicks() < numRequestedTicks_)
+            return 1.0f;
+        return logicTimeAccumulator_ / updatePeriod_;
+    }
 
     void SetUpdatePeriod(float period) { updatePeriod_ = period; }
 
     void SetPaused(bool paused) { menuPaused_ = paused; }
 
+    /// Write recorded ticks, so the replay file is up to date. Waits for simulation thread if it is running.
+    void FlushReplay()
+    {
+        if (!simulationStarted_)
+        {
+            replayWriter_.Flush();
+            return;
+        }
+
+        Post([this] { replayWriter_.Flush(); });
+        WaitIdle();
+    }
+
     void Update(float timeStep)
     {
+        snapshots_.Update();
+
         auto input = context_->GetSubsystem<Input>();
         if (!menuPaused_ && (input->GetKeyPress(KEY_PAUSE) || input->GetKeyPress(KEY_P)))
             keyPaused_ = !keyPaused_;
 
         DoUpdate(timeStep);
 
-        const auto animationType = sim_.GetCurrentAnimationType(GetLogicInterpolationFactor());
+        const auto animationType = GetSnapshot().GetCurrentAnimationType(GetLogicInterpolationFactor());
         const float currentPeriod = settings_.CalculateCurrentPeriod(GetScore(), animationType);
         const float logicUpdatePeriod = currentPeriod * GetArtificialSlowdown();
         const float logicTimeStep = timeStep / logicUpdatePeriod;
@@ -162,45 +215,268 @@ public:
         if (!menuPaused_)
         {
             if (keyPaused_)
-                sim_.UpdateTilt(input->GetMouseMove(), mouseWheel, timeStep);
+                renderer_.UpdateTilt(input->GetMouseMove(), mouseWheel, timeStep);
             else
-                sim_.UpdateTilt(IntVector2::ZERO, 0.0f, timeStep);
+                renderer_.UpdateTilt(IntVector2::ZERO, 0.0f, timeStep);
         }
 
         if (!menuPaused_ && !keyPaused_)
         {
             logicTimeAccumulator_ += logicTimeStep;
-            sim_.UpdateAnimation(timeStep / GetArtificialSlowdown());
+            renderer_.UpdateAnimation(timeStep / GetArtificialSlowdown());
         }
 
         while (logicTimeAccumulator_ >= updatePeriod_)
         {
             logicTimeAccumulator_ -= updatePeriod_;
-            DoTick();
-
-            settings_.animationSettings_.snakeMovementSpeed_ = settings_.CalculateSnakeMovementSpeed(GetScore());
-            sim_.SetAnimationSettings(settings_.animationSettings_);
+            RequestTick();
         }
 
-        sim_.UpdateCamera(GetLogicInterpolationFactor(), timeStep);
+#ifdef SNAKE4D_NO_THREADS
+        RunCommands();
+        snapshots_.Update();
+#endif
+
+        renderer_.UpdateCamera(GetSnapshot(), GetLogicInterpolationFactor(), timeStep);
     }
 
     void Render(Scene4D& scene4D)
     {
-        sim_.Render(scene4D, GetLogicInterpolationFactor(), IsSmoothRotation());
+        renderer_.Render(GetSnapshot(), scene4D, GetLogicInterpolationFactor(), IsSmoothRotation());
     }
 
 protected:
+    /// Return the latest snapshot of the simulation. Should be used only from main thread.
+    const SimulationSnapshot& GetSnapshot() const { return snapshots_.GetReadBuffer(); }
+
+    /// Set user action applied on the next tick.
+    void SetNextAction(UserAction action) { nextAction_ = action; }
+
+    UserAction GetNextAction() const { return nextAction_; }
+
+    /// Estimate best action on planner thread, so the tick doesn't wait for path finder.
+    /// Until the action is planned, cached action for the state or previous best action is used.
+    /// Should be called before simulation is started. Ignored without threads, the tick estimates best action itself.
+    void EnableAsyncPlanning()
+    {
+#ifndef SNAKE4D_NO_THREADS
+        sim_.SetUpdateBestAction(false);
+        sim_.SetActionCache(ea::make_shared<ActionCache>());
+        asyncPlanner_ = ea::make_unique<AsyncActionPlanner>(sim_.GetSize(), [this] { Post([this] { ApplyPlannedAction(); }); });
+#endif
+    }
+
+    /// Start planning of best action for current state. Called on simulation thread after the state is changed.
+    void StartPlanning()
+    {
+        if (!asyncPlanner_ || sim_.IsGameOver())
+            return;
+
+        sim_.UpdateCachedBestAction();
+        asyncPlanner_->Start(sim_);
+    }
+
+    /// Queue command to execute on simulation thread. Snapshot is published after each command.
+    void Post(ea::function<void()> command)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            commands_.push_back(ea::move(command));
+        }
+        commandCondition_.notify_one();
+    }
+
+    /// Wait until simulation thread executes all queued commands or is stopped.
+    void WaitIdle()
+    {
+#ifdef SNAKE4D_NO_THREADS
+        RunCommands();
+#else
+        std::unique_lock<std::mutex> lock(mutex_);
+        idleCondition_.wait(lock, [this] { return stopSimulation_ || (commands_.empty() && !commandRunning_); });
+#endif
+    }
+
+    /// Called on main thread every frame.
     virtual void DoUpdate(float timeStep) = 0;
-    virtual void DoTick() { sim_.Tick(); }
+    /// Called on simulation thread after each tick to set animation settings of the tick.
+    virtual void UpdateAnimationSettings()
+    {
+        settings_.animationSettings_.snakeMovementSpeed_ = settings_.CalculateSnakeMovementSpeed(sim_.GetSnakeLength());
+        sim_.SetAnimationSettings(settings_.animationSettings_);
+    }
+    /// Called on simulation thread for each tick, next action of the simulation is already set.
+    virtual void DoTick()
+    {
+        // Replay file is created on the first tick, after the game is set up
+        if (recordReplay_ && !replayStarted_)
+        {
+            replayStarted_ = true;
+            replayWriter_.Open(replayFileName_, sim_);
+        }
+
+        const UserAction action = sim_.GetNextAction();
+        sim_.Tick();
+        replayWriter_.RecordTick(action, sim_);
+
+        // Replay is complete once the game is over
+        if (sim_.IsGameOver())
+            replayWriter_.Close();
+    }
 
     bool menuPaused_{};
     bool keyPaused_{};
     float updatePeriod_{ 1.0f };
     float logicTimeAccumulator_{};
+    UserAction nextAction_{};
+    unsigned long long numRequestedTicks_{};
 
     GameSettings settings_{};
+    SimulationRenderer renderer_;
+
+    /// Simulation is owned by simulation thread once it is started.
     GameSimulation sim_{ 11 };
+    unsigned long long numSimulatedTicks_{};
+
+    bool recordReplay_{};
+    bool replayStarted_{};
+    ea::string replayFileName_;
+    ReplayWriter replayWriter_;
+
+private:
+    /// Publish initial snapshot, so there is always a snapshot to present. Called on main thread before the thread is started.
+    void BeginSimulation()
+    {
+        snapshots_.GetWriteBuffer().Update(sim_, numSimulatedTicks_);
+        snapshots_.Publish();
+        snapshots_.Update();
+        simulationStarted_ = true;
+    }
+
+    /// Make simulation loop return, pending commands are dropped.
+    void StopSimulation()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopSimulation_ = true;
+            commands_.clear();
+        }
+        commandCondition_.notify_one();
+        idleCondition_.notify_all();
+    }
+
+    void RequestTick()
+    {
+        ++numRequestedTicks_;
+        const UserAction action = nextAction_;
+        nextAction_ = UserAction::None;
+        Post([this, action] { SimulateTick(action); });
+    }
+
+    void SimulateTick(UserAction action)
+    {
+        sim_.SetNextAction(action);
+        DoTick();
+        ++numSimulatedTicks_;
+        StartPlanning();
+        UpdateAnimationSettings();
+    }
+
+    void ApplyPlannedAction()
+    {
+        // Planned action is dropped if the state has changed since planning was started
+        UserAction action{};
+        if (asyncPlanner_->TryGetAction(sim_.GetHash(), action))
+            sim_.SetBestAction(action);
+    }
+
+    void SimulationLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            commandCondition_.wait(lock, [this] { return stopSimulation_ || !commands_.empty(); });
+            if (stopSimulation_)
+                return;
+
+            const ea::function<void()> command = ea::move(commands_.front());
+            commands_.pop_front();
+            commandRunning_ = true;
+            lock.unlock();
+
+            ExecuteCommand(command);
+
+            lock.lock();
+            commandRunning_ = false;
+            idleCondition_.notify_all();
+        }
+    }
+
+    /// Execute queued commands on calling thread. Used instead of simulation thread if there are no threads.
+    void RunCommands()
+    {
+        // Commands may post more commands
+        while (simulationStarted_ && !stopSimulation_ && !commands_.empty())
+        {
+            const ea::function<void()> command = ea::move(commands_.front());
+            commands_.pop_front();
+            ExecuteCommand(command);
+        }
+    }
+
+    /// Execute command and publish snapshot of its result.
+    void ExecuteCommand(const ea::function<void()>& command)
+    {
+        command();
+        snapshots_.GetWriteBuffer().Update(sim_, numSimulatedTicks_);
+        snapshots_.Publish();
+    }
+
+    TripleBuffer<SimulationSnapshot> snapshots_;
+
+    bool simulationStarted_{};
+    std::mutex mutex_;
+    std::condition_variable commandCondition_;
+    std::condition_variable idleCondition_;
+    ea::deque<ea::function<void()>> commands_;
+    bool commandRunning_{};
+    bool stopSimulation_{};
+
+    /// Planner posts commands, so it is destroyed first.
+    ea::unique_ptr<AsyncActionPlanner> asyncPlanner_;
+};
+
+/// Runs commands of game session on dedicated thread.
+/// Thread is joined before the session is released, so commands never see partially destroyed session.
+/// Without threads the session runs its commands itself, so only start and stop of the simulation are left.
+class SimulationThread
+{
+public:
+    explicit SimulationThread(SharedPtr<GameSession> session)
+        : session_(ea::move(session))
+    {
+        session_->BeginSimulation();
+#ifndef SNAKE4D_NO_THREADS
+        thread_ = std::thread([this] { session_->SimulationLoop(); });
+#endif
+    }
+
+    ~SimulationThread()
+    {
+        session_->StopSimulation();
+#ifndef SNAKE4D_NO_THREADS
+        thread_.join();
+#endif
+    }
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+private:
+    SharedPtr<GameSession> session_;
+#ifndef SNAKE4D_NO_THREADS
+    std::thread thread_;
+#endif
 };
 
 class ClassicGameSession : public GameSession
@@ -208,7 +484,13 @@ class ClassicGameSession : public GameSession
     URHO3D_OBJECT(ClassicGameSession, GameSession);
 
 public:
-    ClassicGameSession(Context* context) : GameSession(context) {}
+    ClassicGameSession(Context* context)
+        : GameSession(context)
+    {
+        recordReplay_ = true;
+        // Best action is not shown to the player
+        sim_.SetUpdateBestAction(false);
+    }
 
 protected:
     void DoUpdate(float /*timeStep*/) override
@@ -217,19 +499,19 @@ protected:
         auto input = context_->GetSubsystem<Input>();
 
         if (input->GetKeyPress(KEY_A))
-            sim_.SetNextAction(UserAction::Left);
+            SetNextAction(UserAction::Left);
         if (input->GetKeyPress(KEY_D))
-            sim_.SetNextAction(UserAction::Right);
+            SetNextAction(UserAction::Right);
         if (input->GetKeyPress(KEY_W))
-            sim_.SetNextAction(UserAction::Up);
+            SetNextAction(UserAction::Up);
         if (input->GetKeyPress(KEY_S))
-            sim_.SetNextAction(UserAction::Down);
+            SetNextAction(UserAction::Down);
         if (input->GetKeyPress(KEY_Q))
-            sim_.SetNextAction(UserAction::Red);
+            SetNextAction(UserAction::Red);
         if (input->GetKeyPress(KEY_E))
-            sim_.SetNextAction(UserAction::Blue);
+            SetNextAction(UserAction::Blue);
         if (input->GetKeyPress(KEY_SPACE))
-            sim_.SetNextAction(UserAction::XRoll);
+            SetNextAction(UserAction::XRoll);
     }
 };
 
@@ -242,15 +524,19 @@ public:
         : ClassicGameSession(context)
     {
         settings_.colorRotationSlowdown_ = 2.65f;
-        sim_.Reset(tutorialTargets);
-        sim_.SetExactGuidelines(true);
+        // Rewound game cannot be replayed
+        recordReplay_ = false;
+        sim_.SetRewindCapacity(tutorialRewindCapacity);
+        sim_.Reset(tutorialTargets, static_cast<unsigned long long>(time(0)));
+        renderer_.SetExactGuidelines(true);
+        EnableAsyncPlanning();
     }
 
     bool IsTutorialHintVisible() override { return true; };
 
     ea::string GetTutorialHint() override
     {
-        switch (sim_.GetBestAction())
+        switch (GetSnapshot().GetBestAction())
         {
         case UserAction::Left:  return "A\nLeft";
         case UserAction::Right: return "D\nRight";
@@ -265,7 +551,7 @@ public:
 
     Color GetTutorialHintColor() override
     {
-        const UserAction bestAction = sim_.GetBestAction();
+        const UserAction bestAction = GetSnapshot().GetBestAction();
         if (bestAction == UserAction::None)
             return Color::WHITE;
 
@@ -290,9 +576,9 @@ public:
 
     float GetArtificialSlowdown() override
     {
-        if (sim_.GetNextAction() != sim_.GetBestAction())
+        if (GetNextAction() != GetSnapshot().GetBestAction())
             return settings_.tutorialHintSlowdown_; // User doesn't follow tutorial, do slow-mo
-        else if (sim_.GetNextAction() == UserAction::None)
+        else if (GetNextAction() == UserAction::None)
             return 1.0f; // Idle moving
         else
             return 0.7f; // User pressed correct button, speed up a bit
@@ -301,7 +587,18 @@ public:
 protected:
     void DoUpdate(float timeStep) override
     {
-        if (sim_.GetBestAction() != sim_.GetNextAction())
+        auto input = context_->GetSubsystem<Input>();
+        if (input->GetKeyPress(KEY_BACKSPACE) && GetSnapshot().GetNumTicks() > 0)
+        {
+            Post([this]
+            {
+                sim_.Rewind(tutorialRewindTicks);
+                StartPlanning();
+            });
+            logicTimeAccumulator_ = 0.0f;
+        }
+
+        if (GetSnapshot().GetBestAction() != GetNextAction())
             ClassicGameSession::DoUpdate(timeStep);
     }
 
@@ -315,10 +612,13 @@ protected:
         sim_.SetEnableRolls(redRotationUsed_ && blueRotationUsed_);
 
         GameSession::DoTick();
+    }
+
+    void UpdateAnimationSettings() override
+    {
+        ClassicGameSession::UpdateAnimationSettings();
         if (sim_.GetBestAction() != UserAction::None)
             sim_.SetAnimationSettings(AnimationSettings{ 1.0f, 1.0f, 1.0f });
-        else
-            sim_.SetAnimationSettings(settings_.animationSettings_);
     }
 
     bool redRotationUsed_{};
@@ -330,7 +630,8 @@ class DemoGameSession : public GameSession
     URHO3D_OBJECT(DemoGameSession, GameSession);
 
 public:
-    DemoGameSession(Context* context)
+    /// Perfect play follows Hamiltonian cycle and costs nothing per tick, otherwise tree search is used.
+    DemoGameSession(Context* context, bool perfectPlay = false)
         : GameSession(context)
     {
         settings_.scoreToPeriod_ = { { 0, 0.4f } };
@@ -343,7 +644,22 @@ public:
         settings_.minSnakeMovementSpeed_ = 1.0f;
         settings_.snakeMovementSpeedBasePeriod_ = 0.4f;
         sim_.SetAnimationSettings(settings_.animationSettings_);
-        sim_.SetExactGuidelines(true);
+        renderer_.SetExactGuidelines(true);
+
+        if (perfectPlay)
+        {
+            sim_.SetAutopilotMode(AutopilotMode::HamiltonianCycle);
+            return;
+        }
+
+        // Keep one core for rendering
+        const unsigned numWorkers = ea::max(1u, std::thread::hardware_concurrency()) - 1;
+        planner_ = ea::make_unique<MonteCarloPlanner>(sim_.GetSize(), numWorkers);
+
+        // Don't stall the frame when tick happens
+        MonteCarloSettings plannerSettings;
+        plannerSettings.timeBudget_ = 0.012f;
+        planner_->SetSettings(plannerSettings);
     }
 
     ea::string GetScoreString() override { return FormatScore("AI Score", GetScore()); }
@@ -356,9 +672,73 @@ protected:
     }
     void DoTick() override
     {
-        sim_.SetNextAction(sim_.GetBestAction());
+        sim_.SetNextAction(planner_ ? planner_->PlanAction(sim_) : sim_.GetBestAction());
         GameSession::DoTick();
     }
+
+    ea::unique_ptr<MonteCarloPlanner> planner_;
+};
+
+/// Plays back the last game of the player. Hold F to fast forward, press J to skip ahead without rendering.
+class ReplayGameSession : public GameSession
+{
+    URHO3D_OBJECT(ReplayGameSession, GameSession);
+
+public:
+    ReplayGameSession(Context* context)
+        : GameSession(context)
+    {
+        loaded_ = replay_.Load(replayFileName_) && replay_.StartPlayback(sim_);
+    }
+
+    bool IsLoaded() const { return loaded_; }
+
+    ea::string GetScoreString() override { return FormatScore("Replay", GetScore()); }
+
+    float GetArtificialSlowdown() override { return fastForward_ ? 1.0f / replayFastForwardSpeed : 1.0f; }
+
+protected:
+    void DoUpdate(float timeStep) override
+    {
+        auto input = context_->GetSubsystem<Input>();
+        fastForward_ = input->GetKeyDown(KEY_F);
+
+        if (input->GetKeyPress(KEY_J))
+            Post([this] { PlayTicks(nextTick_ + replaySkipTicks); });
+    }
+
+    void DoTick() override
+    {
+        if (nextTick_ < replay_.GetNumTicks())
+            PlayTicks(nextTick_ + 1);
+    }
+
+    /// Play ticks up to the end tick and report the first tick where simulation diverges from the recorded game.
+    void PlayTicks(unsigned long long endTick)
+    {
+        endTick = ea::min(endTick, replay_.GetNumTicks());
+        if (diverged_)
+        {
+            replay_.Play(sim_, nextTick_, endTick);
+            nextTick_ = endTick;
+            return;
+        }
+
+        const unsigned long long divergentTick = replay_.PlayAndVerify(sim_, nextTick_, endTick);
+        if (divergentTick < endTick)
+        {
+            URHO3D_LOGWARNING("Replay diverged from the recorded game at tick {}", divergentTick);
+            diverged_ = true;
+            replay_.Play(sim_, divergentTick + 1, endTick);
+        }
+        nextTick_ = endTick;
+    }
+
+    GameReplay replay_;
+    bool loaded_{};
+    bool fastForward_{};
+    bool diverged_{};
+    unsigned long long nextTick_{};
 };
 
 class FirstDemoGameSession : public DemoGameSession
@@ -366,7 +746,7 @@ class FirstDemoGameSession : public DemoGameSession
     URHO3D_OBJECT(FirstDemoGameSession, DemoGameSession);
 
 public:
-    FirstDemoGameSession(Context* context) : DemoGameSession(context) {}
+    FirstDemoGameSession(Context* context) : DemoGameSession(context, true) {}
 
     float GetArtificialSlowdown() override { return Lerp(1.0f, 5.0f, slowdown_); }
 
@@ -458,6 +838,10 @@ public:
 
     void StartGame(SharedPtr<GameSession> session)
     {
+        // Previous session is released only after its thread is joined
+        simulationThread_ = nullptr;
+        simulationThread_ = ea::make_unique<SimulationThread>(session);
+
         currentSession_ = session;
         currentSession_->SetPaused(false);
         showMenu_ = false;
@@ -491,12 +875,21 @@ private:
         const auto newGame = [this] { StartGame(MakeShared<ClassicGameSession>(context_)); };
         const auto tutorial = [this] { StartGame(MakeShared<TutorialGameSession>(context_)); };
         const auto demo = [this] { StartGame(MakeShared<DemoGameSession>(context_)); };
+        const auto replay = [this]
+        {
+            if (currentSession_)
+                currentSession_->FlushReplay();
+            auto session = MakeShared<ReplayGameSession>(context_);
+            if (session->IsLoaded())
+                StartGame(session);
+        };
         const auto exit = [this] { SendEvent(E_EXITREQUESTED); };
 
         constructor.BindEventCallback("resume", WrapCallback(resume));
         constructor.BindEventCallback("new_game", WrapCallback(newGame));
         constructor.BindEventCallback("tutorial", WrapCallback(tutorial));
         constructor.BindEventCallback("demo", WrapCallback(demo));
+        constructor.BindEventCallback("replay", WrapCallback(replay));
         constructor.BindEventCallback("exit", WrapCallback(exit));
 
         model_ = constructor.GetModelHandle();
@@ -525,6 +918,8 @@ private:
     const float menuFontSize_{ 24 };
 
     SharedPtr<GameSession> currentSession_;
+    /// Destroyed before current session, so the session outlives its thread.
+    ea::unique_ptr<SimulationThread> simulationThread_;
 
     bool hasKeyboard_{};
     bool hideUi_{ false };
@@ -683,8 +1078,6 @@ void MainApplication::Start()
         return !!gameSession;
     };
 
-    SetRandomSeed(static_cast<unsigned>(time(0)));
-
     gameRenderer_ = MakeShared<GameRenderer>(context_);
     gameRenderer_->Initialize(renderCallback);
 }
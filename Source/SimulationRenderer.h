@@ -1,12 +1,8 @@
 #pragma once
 
-#include "Math4D.h"
 #include "Scene4D.h"
-#include "GridCamera4D.h"
-#include "GridPathFinder4D.h"
+#include "SimulationSnapshot.h"
 
-#include <EASTL/queue.h>
-#include <EASTL/priority_queue.h>
 #include <EASTL/fixed_set.h>
 
 #include <cmath>
@@ -14,34 +10,6 @@
 namespace Urho3D
 {
 
-enum class UserAction
-{
-    None,
-    Left,
-    Right,
-    Up,
-    Down,
-    Red,
-    Blue,
-    XRoll,
-
-    Count
-};
-
-enum class CurrentAnimationType
-{
-    Idle,
-    Rotation,
-    ColorRotation
-};
-
-struct AnimationSettings
-{
-    float cameraTranslationSpeed_{ 1.0f };
-    float cameraRotationSpeed_{ 3.0f };
-    float snakeMovementSpeed_{ 6.0f };
-};
-
 struct RenderSettings
 {
     float snakeThickness_{ 0.8f };
@@ -83,6 +51,14 @@ struct RenderSettings
     };
     float targetThickness_{ 0.1f };
 
+    ColorTriplet obstacleColor_{
+        { 0.6f, 0.6f, 0.6f, 1.0f },
+    };
+    ColorTriplet secondaryObstacleColor_{
+        { 0.4f, 0.4f, 0.4f, 1.0f },
+    };
+    float obstacleThickness_{ 0.05f };
+
     Color borderColor_{ 1.0f, 1.0f, 1.0f, 0.3f };
     float borderQuadSize_{ 0.8f };
     float borderHyperThreshold_{ 0.2f };
@@ -118,75 +94,38 @@ inline CubeFrame MakeInitialCubeFrame()
     };
 }
 
-inline CubeFrame RotateCubeFrame(const CubeFrame& frame, const IntVector4& from, const IntVector4& to)
+inline const CubeFrame& GetRotatedCubeFrame(GridRotationIndex rotation)
+{
+    static const auto frames = []
+    {
+        const CubeFrame initialFrame = MakeInitialCubeFrame();
+        ea::array<CubeFrame, NumGridRotations> result;
+        for (unsigned i = 0; i < NumGridRotations; ++i)
+        {
+            const GridRotation4D frameRotation = GridRotation4D::FromIndex(static_cast<GridRotationIndex>(i));
+            for (unsigned j = 0; j < 8; ++j)
+                result[i][j] = frameRotation * initialFrame[j];
+        }
+        return result;
+    }();
+    return frames[rotation];
+}
+
+inline CubeFrame GetBeginFrameInWorldSpace(const SnakeElement& element, float thickness)
 {
-    const Matrix4 rotation = MakeDeltaRotation(from, to);
+    const CubeFrame& beginFrame = GetRotatedCubeFrame(element.beginFrameRotation_);
+    const Vector4 offset = IntVectorToVector4(DirectionToIntVector(element.beginFrameOffset_)) * 0.5f;
+    const Vector4 position = IndexToPosition(element.position_);
     CubeFrame newFrame;
     for (unsigned i = 0; i < 8; ++i)
-        newFrame[i] = VectorRound(rotation * frame[i]);
+        newFrame[i] = beginFrame[i] * thickness * 0.5f + offset + position;
     return newFrame;
 }
 
-struct SnakeElement
-{
-    IntVector4 position_;
-    CubeFrame beginFrame_;
-    IntVector4 beginFrameOffset_;
-
-    CubeFrame GetBeginFrameInWorldSpace(float thickness) const
-    {
-        const Vector4 position = IndexToPosition(position_);
-        CubeFrame newFrame;
-        for (unsigned i = 0; i < 8; ++i)
-            newFrame[i] = beginFrame_[i] * thickness * 0.5f + IntVectorToVector4(beginFrameOffset_) * 0.5f + position;
-        return newFrame;
-    }
-};
-
-class GameSimulation
+/// Renders snapshot of GameSimulation state into Scene4D. Owns all state that affects only presentation.
+class SimulationRenderer
 {
 public:
-    GameSimulation() = default;
-
-    explicit GameSimulation(int size)
-        : size_(size)
-        , pathFinder_(size)
-    {
-        Reset({});
-    }
-
-    void Reset(ea::span<const IntVector4> targets)
-    {
-        const IntVector4 previousPosition{ size_ / 2, size_ / 2, size_ * 1 / 4 - 1, size_ / 2 };
-        snake_.clear();
-        for (int i = 0; i < 3; ++i)
-        {
-            SnakeElement element;
-            element.position_ = { size_ / 2, size_ / 2, size_ * 1 / 4 - i, size_ / 2 };
-            element.beginFrame_ = MakeInitialCubeFrame();
-            element.beginFrameOffset_ = { 0, 0, -1, 0 };
-            snake_.push_back(element);
-        }
-        previousSnake_ = snake_;
-
-        camera_.Reset(GetSnakeHead(), { 0, 0, 1, 0 }, Matrix4::IDENTITY);
-        targetPosition_ = { size_ / 2, size_ / 2, size_ * 3 / 4, size_ / 2 };
-
-        targetQueue_.get_container().assign(targets.begin(), targets.end());
-        if (!targetQueue_.empty())
-        {
-            targetPosition_ = targetQueue_.front();
-            targetQueue_.pop();
-        }
-
-        // Update path
-        bestAction_ = EstimateBestAction();
-    }
-
-    void SetLengthIncrement(unsigned lengthIncrement) { lengthIncrement_ = lengthIncrement; }
-
-    void SetEnableRolls(bool enableRolls) { enableRolls_ = enableRolls; }
-
     void SetExactGuidelines(bool exactGuidelines) { exactGuidelines_ = exactGuidelines; }
 
     void UpdateTilt(const IntVector2& mouseMove, float mouseScroll, float timeStep)
@@ -222,32 +161,38 @@ public:
         tiltMatrix_ = tiltY * tiltX * tiltXW;
     }
 
-    void Render(Scene4D& scene, float blendFactor, bool smooth) const
+    /// Follow camera of the snapshot, smooth camera is animated independently from ticks.
+    void UpdateCamera(const SimulationSnapshot& sim, float blendFactor, float timeStep)
     {
-        ResetScene(scene, blendFactor, smooth);
-        RenderSnakeHead(scene, blendFactor);
-        RenderSnakeTail(scene, blendFactor);
-        RenderSceneBorders(scene);
-        RenderObjects(scene, blendFactor);
-
-        if (!gameOver_)
+        // Smooth camera starts where simulation camera is reset
+        if (!hasCamera_)
         {
-            if (exactGuidelines_)
-                RenderExactGuidelines(scene);
-            else
-                RenderRawGuidelines(scene);
+            camera_ = sim.GetCamera();
+            hasCamera_ = true;
         }
-    }
+        else
+            camera_.CopyGridState(sim.GetCamera(), sim.GetTopology().IsWrapAround() ? sim.GetSize() : 0);
 
-    void SetAnimationSettings(const AnimationSettings& animationSettings)
-    {
-        animationSettings_ = animationSettings;
+        const float smoothingConstant = 5.0f;
+        camera_.UpdateSmoothCamera(blendFactor, timeStep, smoothingConstant);
     }
 
-    void SetNextAction(UserAction action)
+    void Render(const SimulationSnapshot& sim, Scene4D& scene, float blendFactor, bool smooth) const
     {
-        if (!gameOver_)
-            nextAction_ = action;
+        ResetScene(sim, scene, blendFactor, smooth);
+        RenderSnakeHead(sim, scene, blendFactor);
+        RenderSnakeTail(sim, scene, blendFactor);
+        if (!sim.GetTopology().IsWrapAround())
+            RenderSceneBorders(sim, scene);
+        RenderObjects(sim, scene, blendFactor);
+
+        if (!sim.IsGameOver())
+        {
+            if (exactGuidelines_)
+                RenderExactGuidelines(sim, scene);
+            else
+                RenderRawGuidelines(sim, scene);
+        }
     }
 
     void UpdateAnimation(float timeStep)
@@ -261,180 +206,12 @@ public:
             targetAnimationTimer2_ += 1.0f;
     }
 
-    void UpdateCamera(float blendFactor, float timeStep)
-    {
-        const float smoothingConstant = 5.0f;
-        camera_.UpdateSmoothCamera(blendFactor, timeStep, smoothingConstant);
-    }
-
-    void Tick()
-    {
-        static const RotationDelta4D rotations[static_cast<unsigned>(UserAction::Count)] = {
-            { 0, 1,   0.0f }, // None
-            { 0, 2, -90.0f }, // Left
-            { 0, 2,  90.0f }, // Right
-            { 1, 2,  90.0f }, // Up
-            { 1, 2, -90.0f }, // Down
-            { 2, 3,  90.0f }, // Red
-            { 2, 3, -90.0f }, // Blue
-            { 0, 3,  90.0f }, // XRoll
-        };
-
-        // if the next action lead to immediate death, rollback it
-        if (!gameOver_)
-        {
-            auto testCamera = camera_;
-            const RotationDelta4D testRotationDelta = rotations[static_cast<unsigned>(nextAction_)];
-            testCamera.Step(testRotationDelta, true);
-            if (IsOutside(testCamera.GetCurrentPosition()))
-                nextAction_ = UserAction::None;
-        }
-
-        // Apply user action
-        const bool move = !gameOver_;
-        const RotationDelta4D rotationDelta = rotations[static_cast<unsigned>(nextAction_)];
-        nextAction_ = UserAction::None;
-        deathAnimation_ = false;
-        camera_.Step(rotationDelta, move);
-
-        // Store previous state
-        previousSnake_ = snake_;
-
-        if (gameOver_)
-            return;
-
-        // Move snake
-        {
-            const IntVector4 newPosition = camera_.GetCurrentPosition();
-            const IntVector4 prevDirection = snake_[0].position_ - snake_[1].position_;
-            const IntVector4 newDirection = newPosition - snake_[0].position_;
-
-            SnakeElement element;
-            element.position_ = newPosition;
-            element.beginFrame_ = RotateCubeFrame(snake_.front().beginFrame_, prevDirection, newDirection);
-            element.beginFrameOffset_ = snake_[0].position_ - newPosition;
-            snake_.push_front(element);
-        }
-
-        if (GetSnakeHead() == targetPosition_)
-        {
-            // Generate new target position
-            auto newTarget = GetNextTargetPosition();
-            if (!newTarget.second)
-            {
-                gameOver_ = true;
-                return;
-            }
-
-            targetPosition_ = newTarget.first;
-
-            // Request growth
-            pendingGrowth_ += lengthIncrement_;
-        }
-
-        // Remove tail segment if doesn't grow
-        if (pendingGrowth_ == 0)
-            snake_.pop_back();
-        else
-            --pendingGrowth_;
-
-        // Check for collision
-        if (!IsValidHeadPosition(GetSnakeHead()))
-        {
-            gameOver_ = true;
-            deathAnimation_ = true;
-        }
-
-        // Update path
-        if (!gameOver_)
-            bestAction_ = EstimateBestAction();
-    }
-
-    UserAction GetNextAction() const { return nextAction_; }
-
-    UserAction GetBestAction() const { return bestAction_; }
-
-    UserAction EstimateBestAction()
-    {
-        const IntVector4& startPosition = camera_.GetCurrentPosition();
-        if (IsOutside(startPosition))
-            return UserAction::None;
-
-        const IntVector4& startDirection = camera_.GetCurrentDirection();
-        const auto checkCell = [&](const IntVector4& position) { return IsValidHeadPosition(position); };
-
-        // Find path, do nothing if fail
-        if (!pathFinder_.UpdatePath(startPosition, startDirection, targetPosition_, checkCell))
-            return UserAction::None;
-
-        const IntVector4 offset = pathFinder_.GetNextCellOffset();
-        const int rotateLeftRight = DotProduct(offset, camera_.GetCurrentRight());
-        const int rotateUpDown = DotProduct(offset, camera_.GetCurrentUp());
-        const int rotateRedBlue = DotProduct(offset, camera_.GetCurrentBlue());
-        if (rotateLeftRight < 0)
-            return UserAction::Left;
-        else if (rotateLeftRight > 0)
-            return UserAction::Right;
-        else if (rotateUpDown < 0)
-            return UserAction::Down;
-        else if (rotateUpDown > 0)
-            return UserAction::Up;
-        else if (rotateRedBlue < 0)
-            return UserAction::Red;
-        else if (rotateRedBlue > 0)
-            return UserAction::Blue;
-
-        // Check for roll
-        const int offsetX = DotProduct(targetPosition_ - startPosition, camera_.GetCurrentRight());
-        const int offsetW = DotProduct(targetPosition_ - startPosition, camera_.GetCurrentBlue());
-        if (enableRolls_ && offsetX == 0 && offsetW != 0)
-            return UserAction::XRoll;
-
-        return UserAction::None;
-    }
-
-    CurrentAnimationType GetCurrentAnimationType(float blendFactor) const
-    {
-        if (blendFactor * animationSettings_.cameraRotationSpeed_ >= 1.0f)
-            return CurrentAnimationType::Idle;
-        else if (camera_.IsColorRotating())
-            return CurrentAnimationType::ColorRotation;
-        else if (camera_.IsRotating())
-            return CurrentAnimationType::Rotation;
-        else
-            return CurrentAnimationType::Idle;
-    }
-
-    unsigned GetSnakeLength() const { return snake_.size(); }
-
-    IntVector4 GetSnakeHead() const { return snake_.front().position_; }
-
 private:
-    bool IsOutside(const IntVector4& position) const
-    {
-        const IntVector4 boxBegin{ 0, 0, 0, 0 };
-        const IntVector4 boxEnd{ size_, size_, size_, size_ };
-        return !IsInside(position, boxBegin, boxEnd);
-    }
-
-    bool IsValidHeadPosition(const IntVector4& position) const
-    {
-        if (IsOutside(position))
-            return false;
-
-        for (unsigned i = 1; i < snake_.size(); ++i)
-        {
-            if (position == snake_[i].position_)
-                return false;
-        }
-        return true;
-    }
-
-    void ResetScene(Scene4D& scene, float blendFactor, bool smooth) const
+    void ResetScene(const SimulationSnapshot& sim, Scene4D& scene, float blendFactor, bool smooth) const
     {
         // Update camera
-        const float cameraTranslationFactor = Clamp(blendFactor * animationSettings_.cameraTranslationSpeed_, 0.0f, 1.0f);
-        const float cameraRotationFactor = Clamp(blendFactor * animationSettings_.cameraRotationSpeed_, 0.0f, 1.0f);
+        const float cameraTranslationFactor = Clamp(blendFactor * sim.GetAnimationSettings().cameraTranslationSpeed_, 0.0f, 1.0f);
+        const float cameraRotationFactor = Clamp(blendFactor * sim.GetAnimationSettings().cameraRotationSpeed_, 0.0f, 1.0f);
         const Matrix4x5 cameraMatrix = smooth
             ? camera_.GetSmoothViewMatrix()
             : camera_.GetViewMatrix(cameraTranslationFactor, cameraRotationFactor);
@@ -443,7 +220,7 @@ private:
         scene.Reset(tiltMatrix_ * cameraMatrix);
 
         scene.cameraOffset_ = Vector3::ZERO;
-        if (deathAnimation_)
+        if (sim.HasDeathAnimation())
         {
             const float sine = Sin(blendFactor * renderSettings_.deathShakeFrequency_ * 360.0f);
             const float exp = std::exp(-blendFactor * renderSettings_.deathShakeSaturation_);
@@ -451,19 +228,22 @@ private:
         }
     }
 
-    void RenderSnakeHead(Scene4D& scene, float blendFactor) const
+    void RenderSnakeHead(const SimulationSnapshot& sim, Scene4D& scene, float blendFactor) const
     {
-        const float snakeMovementFactor = Clamp(blendFactor * animationSettings_.snakeMovementSpeed_, 0.0f, 1.0f);
-        const float size = deathAnimation_
+        const float snakeMovementFactor = Clamp(blendFactor * sim.GetAnimationSettings().snakeMovementSpeed_, 0.0f, 1.0f);
+        const float size = sim.HasDeathAnimation()
             ? ea::max(0.0f, 1.0f - blendFactor * renderSettings_.deathCollapseSpeed_)
-            : gameOver_
+            : sim.IsGameOver()
             ? 0.0f
             : 1.0f;
 
         if (size > M_EPSILON)
         {
-            const Vector4 previousPosition = IndexToPosition(previousSnake_.front().position_);
-            const Vector4 currentPosition = IndexToPosition(snake_.front().position_);
+            // Head that has just wrapped around moves in from outside of the board
+            const SnakeBody& snake = sim.GetSnake();
+            const IntVector4 movement = sim.GetTopology().GetDelta(snake.GetPrevious(0).position_, snake.Front().position_);
+            const Vector4 previousPosition = IndexToPosition(snake.Front().position_ - movement);
+            const Vector4 currentPosition = IndexToPosition(snake.Front().position_);
 
             Tesseract tesseract;
             tesseract.position_ = Lerp(previousPosition, currentPosition, snakeMovementFactor);
@@ -476,24 +256,29 @@ private:
         }
     }
 
-    void RenderSnakeTail(Scene4D& scene, float blendFactor) const
+    void RenderSnakeTail(const SimulationSnapshot& sim, Scene4D& scene, float blendFactor) const
     {
         CustomTesseract tesseract;
         tesseract.color_ = renderSettings_.snakeColor_;
         tesseract.secondaryColor_ = renderSettings_.secondarySnakeColor_;
         tesseract.thickness_ = renderSettings_.snakeFrameThickness_;
 
-        const float snakeMovementFactor = Clamp(blendFactor * animationSettings_.snakeMovementSpeed_, 0.0f, 1.0f);
+        const float snakeMovementFactor = Clamp(blendFactor * sim.GetAnimationSettings().snakeMovementSpeed_, 0.0f, 1.0f);
 
-        const unsigned oldLength = previousSnake_.size();
-        const unsigned newLength = snake_.size();
+        const SnakeBody& snake = sim.GetSnake();
+        const unsigned oldLength = snake.GetPreviousSize();
+        const unsigned newLength = snake.Size();
         const unsigned commonLength = ea::min(oldLength, newLength);
         for (unsigned i = 1; i < commonLength; ++i)
         {
-            const CubeFrame previousEndFrame = GetBeginFrame(previousSnake_[i - 1]);
-            const CubeFrame currentEndFrame = GetBeginFrame(snake_[i - 1]);
-            const CubeFrame previousBeginFrame = GetBeginFrame(previousSnake_[i]);
-            const CubeFrame currentBeginFrame = GetBeginFrame(snake_[i]);
+            // Segments that cross the edge of wrapped board are skipped
+            if (IsSegmentWrapped(sim, snake.GetPrevious(i - 1), snake.GetPrevious(i)) || IsSegmentWrapped(sim, snake[i - 1], snake[i]))
+                continue;
+
+            const CubeFrame previousEndFrame = GetBeginFrame(snake.GetPrevious(i - 1));
+            const CubeFrame currentEndFrame = GetBeginFrame(snake[i - 1]);
+            const CubeFrame previousBeginFrame = GetBeginFrame(snake.GetPrevious(i));
+            const CubeFrame currentBeginFrame = GetBeginFrame(snake[i]);
             for (unsigned j = 0; j < 8; ++j)
             {
                 tesseract.positions_[j] = Lerp(previousBeginFrame[j], currentBeginFrame[j], snakeMovementFactor);
@@ -503,11 +288,12 @@ private:
         }
 
         // Animate growth
-        if (commonLength < newLength)
+        if (commonLength < newLength && !IsSegmentWrapped(sim, snake.GetPrevious(commonLength - 1), snake[commonLength])
+            && !IsSegmentWrapped(sim, snake[commonLength - 1], snake[commonLength]))
         {
-            const CubeFrame previousEndFrame = GetBeginFrame(previousSnake_[commonLength - 1]);
-            const CubeFrame currentEndFrame = GetBeginFrame(snake_[commonLength - 1]);
-            const CubeFrame beginFrame = GetBeginFrame(snake_[commonLength]);
+            const CubeFrame previousEndFrame = GetBeginFrame(snake.GetPrevious(commonLength - 1));
+            const CubeFrame currentEndFrame = GetBeginFrame(snake[commonLength - 1]);
+            const CubeFrame beginFrame = GetBeginFrame(snake[commonLength]);
             for (unsigned j = 0; j < 8; ++j)
             {
                 tesseract.positions_[j] = beginFrame[j];
@@ -517,7 +303,7 @@ private:
         }
     }
 
-    void RenderSceneBorders(Scene4D& scene) const
+    void RenderSceneBorders(const SimulationSnapshot& sim, Scene4D& scene) const
     {
         // Render borders
         static const IntVector4 directions[8] = {
@@ -535,7 +321,7 @@ private:
         const Vector4 hyperFlattenMask = GetAxisFlattenMask(hyperAxisIndex);
         const Vector4 cameraPosition = IndexToPosition(camera_.GetCurrentPosition());
 
-        const float halfSize = size_ * 0.5f;
+        const float halfSize = sim.GetSize() * 0.5f;
         for (int directionIndex = 0; directionIndex < 4; ++directionIndex)
         {
             for (float sign : { -1.0f, 1.0f })
@@ -559,9 +345,9 @@ private:
                 const float upwardFade = Clamp(InverseLerp(
                     renderSettings_.borderUpwardThreshold_, 1.0f, viewSpaceDirection.y_), 0.0f, 1.0f);
 
-                for (int x = 0; x < size_; ++x)
+                for (int x = 0; x < sim.GetSize(); ++x)
                 {
-                    for (int y = 0; y < size_; ++y)
+                    for (int y = 0; y < sim.GetSize(); ++y)
                     {
                         Quad quad;
 
@@ -595,9 +381,9 @@ private:
         }
     }
 
-    void RenderRawGuidelines(Scene4D& scene) const
+    void RenderRawGuidelines(const SimulationSnapshot& sim, Scene4D& scene) const
     {
-        const Vector4 viewSpaceTargetPosition = camera_.GetCurrentViewMatrix() * IndexToPosition(targetPosition_);
+        const Vector4 viewSpaceTargetPosition = camera_.GetCurrentViewMatrix() * IndexToPosition(sim.GetTargetPosition());
         const Matrix4x5 viewToWorldSpaceTransform = camera_.GetCurrentModelMatrix();
 
         const Vector4 xAxis = viewToWorldSpaceTransform.rotation_ * Vector4(1.0f, 0.0f, 0.0f, 0.0f);
@@ -605,7 +391,7 @@ private:
         const Vector4 zAxis = viewToWorldSpaceTransform.rotation_ * Vector4(0.0f, 0.0f, 1.0f, 0.0f);
         const Vector4 wAxis = viewToWorldSpaceTransform.rotation_ * Vector4(0.0f, 0.0f, 0.0f, 1.0f);
 
-        const float wDelta = wAxis.DotProduct(IndexToPosition(targetPosition_) - IndexToPosition(GetSnakeHead()));
+        const float wDelta = wAxis.DotProduct(IndexToPosition(sim.GetTargetPosition()) - IndexToPosition(sim.GetSnakeHead()));
         const ColorTriplet guidelineColor = wDelta < -M_LARGE_EPSILON
             ? renderSettings_.redGuidelineColor_
             : wDelta > M_LARGE_EPSILON
@@ -617,7 +403,7 @@ private:
         {
             const Vector4 viewSpacePosition{ x, y, z, 0.0f };
             const Vector4 worldSpacePosition = viewToWorldSpaceTransform * viewSpacePosition;
-            const bool isValidLocation = IsValidHeadPosition(PositionToIndex(worldSpacePosition));
+            const bool isValidLocation = sim.IsValidHeadPosition(PositionToIndex(worldSpacePosition));
             const float size = isValidLocation ? renderSettings_.openGuidelineSize_ : renderSettings_.blockedGuidelineSize_;
 
             Cube cube;
@@ -665,7 +451,7 @@ private:
         }
     }
 
-    void RenderExactGuidelines(Scene4D& scene) const
+    void RenderExactGuidelines(const SimulationSnapshot& sim, Scene4D& scene) const
     {
         const Matrix4x5 worldToViewSpaceTransform = camera_.GetCurrentViewMatrix();
         const Matrix4x5 viewToWorldSpaceTransform = camera_.GetCurrentModelMatrix();
@@ -675,7 +461,7 @@ private:
         const Vector4 zAxis = viewToWorldSpaceTransform.rotation_ * Vector4(0.0f, 0.0f, 1.0f, 0.0f);
         const Vector4 wAxis = viewToWorldSpaceTransform.rotation_ * Vector4(0.0f, 0.0f, 0.0f, 1.0f);
 
-        const float wDelta = wAxis.DotProduct(IndexToPosition(targetPosition_) - IndexToPosition(GetSnakeHead()));
+        const float wDelta = wAxis.DotProduct(IndexToPosition(sim.GetTargetPosition()) - IndexToPosition(sim.GetSnakeHead()));
         const ColorTriplet guidelineColor = wDelta < -M_LARGE_EPSILON
             ? renderSettings_.redGuidelineColor_
             : wDelta > M_LARGE_EPSILON
@@ -686,7 +472,7 @@ private:
         const auto createElement = [&](const Vector3& viewSpacePosition)
         {
             const Vector4 worldSpacePosition = viewToWorldSpaceTransform * Vector4{ viewSpacePosition, 0.0f };
-            const bool isValidLocation = IsValidHeadPosition(PositionToIndex(worldSpacePosition));
+            const bool isValidLocation = sim.IsValidHeadPosition(PositionToIndex(worldSpacePosition));
             const float size = isValidLocation ? renderSettings_.openGuidelineSize_ : renderSettings_.blockedGuidelineSize_;
 
             Cube cube;
@@ -700,7 +486,7 @@ private:
 
         // Collect cubes to render
         ea::fixed_set<Vector3, 1024> guideline;
-        for (const IntVector4& pathElement : pathFinder_.GetPath())
+        for (const IntVector4& pathElement : sim.GetPath())
         {
             const Vector4 viewSpacePosition = worldToViewSpaceTransform * IndexToPosition(pathElement);
             const Vector3 guidelineElement = VectorRound(static_cast<Vector3>(viewSpacePosition));
@@ -708,7 +494,7 @@ private:
         }
 
         // Always remove head
-        const Vector4 headViewSpacePosition = worldToViewSpaceTransform * IndexToPosition(GetSnakeHead());
+        const Vector4 headViewSpacePosition = worldToViewSpaceTransform * IndexToPosition(sim.GetSnakeHead());
         const Vector3 headGuidelineElement = VectorRound(static_cast<Vector3>(headViewSpacePosition));
         guideline.erase(headGuidelineElement);
 
@@ -717,11 +503,10 @@ private:
             createElement(guidelineElement);
     }
 
-    void RenderObjects(Scene4D& scene, float blendFactor) const
+    void RenderObjects(const SimulationSnapshot& sim, Scene4D& scene, float blendFactor) const
     {
-        // Render target
+        // Render targets
         Tesseract tesseract;
-        tesseract.position_ = IndexToPosition(targetPosition_);
         tesseract.size_ = Vector4::ONE * 0.6f;
         tesseract.color_ = renderSettings_.targetColor_;
         tesseract.secondaryColor_ = renderSettings_.secondaryTargetColor_;
@@ -737,86 +522,36 @@ private:
             * Matrix4x5::MakeRotation(2, 3, angle3)
             * Matrix4x5::MakeRotation(0, 3, angle4);
 
-        scene.rotatedWireframeTesseracts_.emplace_back(tesseract, rotationMatrix.rotation_);
-    }
-
-    ea::pair<IntVector4, bool> GetNextTargetPosition()
-    {
-        if (!targetQueue_.empty())
+        for (const IntVector4& targetPosition : sim.GetTargetPositions())
         {
-            const IntVector4 nextTarget = targetQueue_.front();
-            targetQueue_.pop();
-            return { nextTarget, true };
+            tesseract.position_ = IndexToPosition(targetPosition);
+            scene.rotatedWireframeTesseracts_.emplace_back(tesseract, rotationMatrix.rotation_);
         }
 
-        return GetAvailablePosition();
-    }
-
-    bool IsBlockedBySnake(const IntVector4& pos) const
-    {
-        for (const SnakeElement& element : snake_)
+        // Render obstacles
+        tesseract.size_ = Vector4::ONE;
+        tesseract.color_ = renderSettings_.obstacleColor_;
+        tesseract.secondaryColor_ = renderSettings_.secondaryObstacleColor_;
+        tesseract.thickness_ = renderSettings_.obstacleThickness_;
+        sim.GetObstacles().ForEach([&](const IntVector4& position)
         {
-            if (element.position_ == pos)
-                return true;
-        }
-        return false;
-    };
+            tesseract.position_ = IndexToPosition(position);
+            scene.wireframeTesseracts_.push_back(tesseract);
+        });
+    }
 
-    ea::pair<IntVector4, bool> GetAvailablePosition() const
+    static bool IsSegmentWrapped(const SimulationSnapshot& sim, const SnakeElement& end, const SnakeElement& begin)
     {
-        static const int maxRetry = 10;
-        for (int i = 0; i < maxRetry; ++i)
-        {
-            const IntVector4 position = RandomIntVector4(size_);
-            if (!IsBlockedBySnake(position))
-                return { position, true };
-        }
-
-        for (int w = 0; w < size_; ++w)
-        {
-            for (int z = 0; z < size_; ++z)
-            {
-                for (int y = 0; y < size_; ++y)
-                {
-                    for (int x = 0; x < size_; ++x)
-                    {
-                        const IntVector4 position{ x, y, z, w };
-                        if (!IsBlockedBySnake(position))
-                            return { position, true };
-                    }
-                }
-            }
-        }
-
-        return { {}, false };
+        return end.position_ - begin.position_ != sim.GetTopology().GetDelta(begin.position_, end.position_);
     }
 
     CubeFrame GetBeginFrame(const SnakeElement& element) const
     {
-        return element.GetBeginFrameInWorldSpace(renderSettings_.snakeThickness_);
+        return GetBeginFrameInWorldSpace(element, renderSettings_.snakeThickness_);
     }
 
-    int size_{};
-    AnimationSettings animationSettings_;
     RenderSettings renderSettings_;
-
-    GridCamera4D camera_;
-
-    UserAction nextAction_{};
-    UserAction bestAction_{};
-    bool gameOver_{};
-    bool deathAnimation_{};
-
-    unsigned lengthIncrement_{ 3 };
-    bool enableRolls_{ true };
     bool exactGuidelines_{ false };
-    unsigned pendingGrowth_{};
-    ea::vector<SnakeElement> snake_;
-    ea::vector<SnakeElement> previousSnake_;
-
-    ea::queue<IntVector4> targetQueue_;
-    IntVector4 targetPosition_{};
-    GridPathFinder4D pathFinder_;
 
     float targetAnimationTimer1_{};
     float targetAnimationTimer2_{};
@@ -826,6 +561,9 @@ private:
     Vector3 accumulatedTilt_;
     float tiltResetCooldown_{};
     Matrix4x5 tiltMatrix_{ Matrix4x5::MakeIdentity() };
+
+    GridCamera4D camera_;
+    bool hasCamera_{};
 };
 
 }
@@ -0,0 +1,46 @@
+#include "AsyncActionPlanner.h"
+#include "TestFramework.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace Urho3D;
+
+TEST_CASE(AsyncActionPlannerMatchesSimulation)
+{
+    const int gridSize = 5;
+    std::atomic<unsigned> numPlanned{};
+    AsyncActionPlanner planner(gridSize, [&] { ++numPlanned; });
+
+    GameSimulation sim(gridSize);
+    sim.SetLengthIncrement(3);
+    sim.Reset({}, 4);
+
+    // Reference restores the same sequence of states as the planner, so path finder reuses the same paths
+    GameSimulation reference(gridSize);
+    SimulationState state;
+
+    UserAction action{};
+    CHECK(!planner.TryGetAction(sim.GetHash(), action));
+
+    for (unsigned tick = 0; tick < 200 && !sim.IsGameOver(); ++tick)
+    {
+        const unsigned numPlannedBefore = numPlanned;
+        planner.Start(sim);
+        while (numPlanned == numPlannedBefore)
+            std::this_thread::yield();
+
+        reference.CopySettings(sim);
+        sim.SaveState(state);
+        reference.RestoreState(state);
+        const UserAction expectedAction = reference.EstimateBestAction();
+
+        CHECK(planner.TryGetAction(sim.GetHash(), action));
+        CHECK(action == expectedAction);
+        CHECK(!planner.TryGetAction(sim.GetHash() + 1, action));
+
+        sim.SetNextAction(action);
+        sim.Tick();
+    }
+    CHECK(sim.GetSnakeLength() > 3);
+}
@@ -0,0 +1,86 @@
+#include "GameReplay.h"
+#include "TestFramework.h"
+
+#include <EASTL/vector.h>
+
+#include <cstdio>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const int gridSize = 7;
+const char* replayFileName = "Snake4DTestsReplay.bin";
+
+}
+
+TEST_CASE(GameReplayRoundTrip)
+{
+    const IntVector4 targets[] = { { 3, 3, 5, 3 }, { 1, 2, 3, 4 } };
+
+    GameSimulation sim(gridSize);
+    sim.SetLengthIncrement(2);
+    sim.SetNumTargets(2);
+    sim.SetWrapAround(true);
+    sim.Reset(targets, 5);
+
+    ReplayWriter writer;
+    CHECK(writer.Open(replayFileName, sim));
+
+    ea::vector<UserAction> actions;
+    ea::vector<unsigned short> checksums;
+    for (unsigned i = 0; i < 300 && !sim.IsGameOver(); ++i)
+    {
+        // Roll keeps heading, it covers the largest action value
+        const UserAction action = i % 16 == 5 ? UserAction::XRoll : sim.GetBestAction();
+        sim.SetNextAction(action);
+        sim.Tick();
+        writer.RecordTick(action, sim);
+        actions.push_back(action);
+        checksums.push_back(sim.GetChecksum());
+
+        // Flushed file must be a valid replay of complete ticks
+        if (i == 100)
+        {
+            writer.Flush();
+            GameReplay partialReplay;
+            CHECK(partialReplay.Load(replayFileName));
+            CHECK(partialReplay.GetNumTicks() <= actions.size());
+            for (unsigned long long tick = 0; tick < partialReplay.GetNumTicks(); ++tick)
+                CHECK(partialReplay.GetAction(tick) == actions[tick]);
+        }
+    }
+    writer.Close();
+
+    const unsigned numTicks = actions.size();
+    CHECK(numTicks > 100);
+
+    GameReplay replay;
+    CHECK(replay.Load(replayFileName));
+    CHECK(replay.GetNumTicks() == numTicks);
+    for (unsigned tick = 0; tick < numTicks; ++tick)
+    {
+        CHECK(replay.GetAction(tick) == actions[tick]);
+        CHECK(replay.GetChecksum(tick) == checksums[tick]);
+    }
+
+    // Playback applies recorded settings itself
+    GameSimulation playbackSim(gridSize);
+    playbackSim.SetUpdateBestAction(false);
+    CHECK(replay.StartPlayback(playbackSim));
+    CHECK(replay.PlayAndVerify(playbackSim, 0, numTicks) == numTicks);
+    CHECK(playbackSim.GetHash() == sim.GetHash());
+
+    // Different settings must be reported as divergence
+    GameSimulation divergentSim(gridSize);
+    divergentSim.SetUpdateBestAction(false);
+    CHECK(replay.StartPlayback(divergentSim));
+    divergentSim.SetLengthIncrement(3);
+    CHECK(replay.PlayAndVerify(divergentSim, 0, numTicks) < numTicks);
+
+    GameSimulation otherSizeSim(gridSize + 1);
+    CHECK(!replay.StartPlayback(otherSizeSim));
+
+    remove(replayFileName);
+}
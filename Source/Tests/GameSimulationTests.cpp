@@ -0,0 +1,70 @@
+#include "GameSimulation.h"
+#include "TestFramework.h"
+
+#include <EASTL/sort.h>
+#include <EASTL/vector.h>
+
+using namespace Urho3D;
+
+TEST_CASE(SimulationFillsBoardWithTargets)
+{
+    // Every free cell becomes a target, even when random samples hit targets most of the time
+    const int gridSize = 4;
+    GameSimulation sim(gridSize);
+    sim.SetNumTargets(gridSize * gridSize * gridSize * gridSize);
+    sim.Reset({}, 11);
+
+    unsigned numSnakeCells = 0;
+    for (unsigned i = 0; i < sim.GetSnakeLength(); ++i)
+        numSnakeCells += !sim.IsOutside(sim.GetSnake()[i].position_);
+
+    ea::vector<unsigned long long> targetIndices;
+    for (const IntVector4& position : sim.GetTargetPositions())
+    {
+        CHECK(!sim.IsOutside(position));
+        CHECK(!sim.IsOccupied(position));
+        targetIndices.push_back(FlattenGridIndex(position, gridSize));
+    }
+
+    ea::sort(targetIndices.begin(), targetIndices.end());
+    CHECK(ea::unique(targetIndices.begin(), targetIndices.end()) == targetIndices.end());
+    CHECK(targetIndices.size() + numSnakeCells == gridSize * gridSize * gridSize * gridSize);
+}
+
+TEST_CASE(SimulationHeadValidityMatchesBodyWalk)
+{
+    // Random actions make the snake bite itself sooner or later
+    const int gridSize = 5;
+    for (const bool wrapAround : { false, true })
+    {
+        RandomGenerator random{ 21 };
+        for (unsigned game = 0; game < 20; ++game)
+        {
+            GameSimulation sim(gridSize);
+            sim.SetWrapAround(wrapAround);
+            sim.SetLengthIncrement(5);
+            sim.Reset({}, game);
+
+            for (unsigned tick = 0; tick < 500 && !sim.IsGameOver(); ++tick)
+            {
+                const bool randomAction = random.Next(4) == 0;
+                sim.SetNextAction(randomAction ? static_cast<UserAction>(random.Next(5)) : sim.GetBestAction());
+                sim.Tick();
+
+                const bool headValid = IsValidHeadPosition(sim.GetTopology(), sim.GetObstacles(), sim.GetSnake(), sim.GetSnakeHead());
+                CHECK(sim.HasDeathAnimation() == !headValid);
+                if (sim.IsGameOver())
+                    break;
+
+                IntVector4 position{};
+                for (int index = 0; index < gridSize * gridSize * gridSize * gridSize; ++index)
+                {
+                    CHECK(sim.IsValidHeadPosition(position)
+                        == IsValidHeadPosition(sim.GetTopology(), sim.GetObstacles(), sim.GetSnake(), position));
+                    for (int i = 0; i < 4 && ++position[i] == gridSize; ++i)
+                        position[i] = 0;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#include "GridChunkedArray4D.h"
+#include "TestFramework.h"
+
+#include <EASTL/unordered_set.h>
+#include <EASTL/vector.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const int regionSize = 20;
+
+unsigned FlattenRegionIndex(const IntVector4& pos)
+{
+    return static_cast<unsigned>(((pos[3] * regionSize + pos[2]) * regionSize + pos[1]) * regionSize + pos[0]);
+}
+
+/// Write random cells of the region placed at given offset and compare the array with dense reference.
+template <class T>
+void CheckAgainstDenseArray(T& array, const IntVector4& regionOffset, RandomGenerator& random)
+{
+    const unsigned numCells = regionSize * regionSize * regionSize * regionSize;
+    ea::vector<int> reference(numCells, array.GetDefaultValue());
+    ea::unordered_set<unsigned long long> touchedChunks;
+
+    for (unsigned i = 0; i < 2000; ++i)
+    {
+        const IntVector4 pos = RandomIntVector4(random, regionSize);
+        const IntVector4 cell = pos + regionOffset;
+        const int value = static_cast<int>(random.Next(1000));
+
+        if (i % 2)
+            array.Set(cell, value);
+        else
+            array.GetOrCreate(cell) = value;
+        reference[FlattenRegionIndex(pos)] = value;
+
+        unsigned long long chunkKey = 0;
+        for (int axis = 0; axis < 4; ++axis)
+            chunkKey = chunkKey * 0x10000 + static_cast<unsigned>(cell[axis] / T::ChunkSize);
+        touchedChunks.insert(chunkKey);
+    }
+    CHECK(array.GetNumChunks() == touchedChunks.size());
+
+    for (unsigned index = 0; index < numCells; ++index)
+    {
+        IntVector4 pos;
+        unsigned remainder = index;
+        for (int axis = 0; axis < 4; ++axis)
+        {
+            pos[axis] = static_cast<int>(remainder % regionSize);
+            remainder /= regionSize;
+        }
+
+        CHECK(array.Get(pos + regionOffset) == reference[index]);
+        CHECK(array.GetConcurrent(pos + regionOffset) == reference[index]);
+    }
+}
+
+}
+
+TEST_CASE(GridChunkedArrayMatchesDenseArray)
+{
+    RandomGenerator random{ 11 };
+
+    GridChunkedArray4D<int> array(-1);
+    CHECK(array.Get({ 1, 2, 3, 4 }) == -1);
+    CheckAgainstDenseArray(array, { 0, 0, 0, 0 }, random);
+
+    // Cleared bricks are reused and must read as default
+    array.Clear();
+    CHECK(array.GetNumChunks() == 0);
+    CHECK(array.Get({ 1, 2, 3, 4 }) == -1);
+    CheckAgainstDenseArray(array, { 0, 0, 0, 0 }, random);
+
+    // Far coordinates must not alias near ones
+    array.Reset();
+    CheckAgainstDenseArray(array, { 500000, 3, 70000, 9 }, random);
+    CHECK(array.Get({ 0, 3, 0, 9 }) == -1);
+
+    GridChunkedArray4D<int, 2> smallChunkArray(-1);
+    CheckAgainstDenseArray(smallChunkArray, { 5, 6, 7, 8 }, random);
+}
@@ -0,0 +1,173 @@
+#include "GridFreeCellSet4D.h"
+#include "TestFramework.h"
+#include "ZobristHash.h"
+
+#include <EASTL/vector.h>
+
+using namespace Urho3D;
+
+TEST_CASE(GridFreeCellSetCountsCellsOfHugeBoards)
+{
+    // Number of cells of these boards doesn't fit into 32 bits
+    for (const int gridSize : { 256, 300 })
+    {
+        const auto size = static_cast<unsigned long long>(gridSize);
+        const unsigned long long numCells = size * size * size * size;
+        const IntVector4 firstCell{ 0, 0, 0, 0 };
+        const IntVector4 lastCell{ gridSize - 1, gridSize - 1, gridSize - 1, gridSize - 1 };
+        CHECK(FlattenGridIndex(lastCell, gridSize) == numCells - 1);
+
+        GridFreeCellSet4D freeCells(gridSize);
+        CHECK(!freeCells.IsEmpty());
+        CHECK(freeCells.Size() == numCells);
+
+        freeCells.Remove(firstCell);
+        freeCells.Remove(lastCell);
+        freeCells.Remove(lastCell);
+        CHECK(freeCells.Size() == numCells - 2);
+        CHECK(!freeCells.Contains(firstCell));
+        CHECK(!freeCells.Contains(lastCell));
+
+        freeCells.Insert(lastCell);
+        CHECK(freeCells.Size() == numCells - 1);
+        CHECK(freeCells.Contains(lastCell));
+    }
+
+    // Cells that alias in 32 bits have distinct keys
+    const unsigned long long wrappedIndex = FlattenGridIndex({ 0, 0, 0, 256 }, 256);
+    CHECK(wrappedIndex == 1ull << 32);
+    CHECK(GetZobristKey(ZobristFeature::SnakeCell, wrappedIndex) != GetZobristKey(ZobristFeature::SnakeCell, 0));
+}
+
+TEST_CASE(GridFreeCellSetSamplesCrowdedLargeBoard)
+{
+    // Large board with only few free cells, rejection sampling gives up and falls back to scan
+    const int gridSize = 48;
+    const IntVector4 freePositions[] = { { 0, 0, 0, 0 }, { 17, 3, 40, 22 }, { 47, 47, 47, 47 } };
+
+    GridFreeCellSet4D freeCells(gridSize);
+    for (int w = 0; w < gridSize; ++w)
+    {
+        for (int z = 0; z < gridSize; ++z)
+        {
+            for (int y = 0; y < gridSize; ++y)
+            {
+                for (int x = 0; x < gridSize; ++x)
+                    freeCells.Remove({ x, y, z, w });
+            }
+        }
+    }
+    CHECK(freeCells.IsEmpty());
+
+    for (const IntVector4& freePosition : freePositions)
+        freeCells.Insert(freePosition);
+    CHECK(freeCells.Size() == 3);
+
+    RandomGenerator random{ 7 };
+    bool sampled[3]{};
+    for (unsigned i = 0; i < 200; ++i)
+    {
+        const IntVector4 sample = freeCells.GetRandomCell(random);
+        CHECK(freeCells.Contains(sample));
+        for (unsigned j = 0; j < 3; ++j)
+            sampled[j] = sampled[j] || sample == freePositions[j];
+    }
+    // Scan favors cells after long occupied runs, first cell is only found from itself
+    CHECK(sampled[1] && sampled[2]);
+}
+
+TEST_CASE(GridFreeCellSetTracksOccupancy)
+{
+    for (const int gridSize : { 3, 7 })
+    {
+        const unsigned numCells = gridSize * gridSize * gridSize * gridSize;
+        ea::vector<bool> reference(numCells, true);
+        unsigned numFreeCells = numCells;
+
+        GridFreeCellSet4D freeCells(gridSize);
+        RandomGenerator random{ 3 };
+        for (unsigned i = 0; i < 5000; ++i)
+        {
+            const IntVector4 position = RandomIntVector4(random, gridSize);
+            const unsigned index = static_cast<unsigned>(FlattenGridIndex(position, gridSize));
+            const bool insert = random.Next(2) == 0;
+            if (insert)
+                freeCells.Insert(position);
+            else
+                freeCells.Remove(position);
+            numFreeCells += insert && !reference[index] ? 1 : 0;
+            numFreeCells -= !insert && reference[index] ? 1 : 0;
+            reference[index] = insert;
+
+            CHECK(freeCells.Contains(position) == insert);
+            CHECK(freeCells.Size() == numFreeCells);
+            if (!freeCells.IsEmpty())
+                CHECK(reference[FlattenGridIndex(freeCells.GetRandomCell(random), gridSize)]);
+        }
+    }
+}
+
+TEST_CASE(GridFreeCellSetSamplesUniformly)
+{
+    const int gridSize = 5;
+    const unsigned numCells = gridSize * gridSize * gridSize * gridSize;
+
+    // Mostly free board is sampled by rejection, crowded board falls back to search of k-th free cell
+    for (const unsigned numFreeCells : { 400u, 10u })
+    {
+        GridFreeCellSet4D freeCells(gridSize);
+        RandomGenerator random{ 5 };
+        while (freeCells.Size() > numFreeCells)
+            freeCells.Remove(RandomIntVector4(random, gridSize));
+
+        const unsigned samplesPerCell = 400;
+        ea::vector<unsigned> counts(numCells);
+        for (unsigned i = 0; i < numFreeCells * samplesPerCell; ++i)
+            ++counts[FlattenGridIndex(freeCells.GetRandomCell(random), gridSize)];
+
+        IntVector4 position{};
+        for (unsigned index = 0; index < numCells; ++index)
+        {
+            // About 7 standard deviations
+            if (freeCells.Contains(position))
+                CHECK(counts[index] > samplesPerCell * 2 / 3 && counts[index] < samplesPerCell * 4 / 3);
+            else
+                CHECK(counts[index] == 0);
+
+            for (int i = 0; i < 4 && ++position[i] == gridSize; ++i)
+                position[i] = 0;
+        }
+    }
+}
+
+TEST_CASE(GridFreeCellSetSamplingIgnoresHistory)
+{
+    // Equal sets built in different order sample equal cells
+    const int gridSize = 6;
+    ea::vector<IntVector4> occupied;
+    RandomGenerator random{ 9 };
+    for (unsigned i = 0; i < 900; ++i)
+        occupied.push_back(RandomIntVector4(random, gridSize));
+
+    GridFreeCellSet4D forward(gridSize);
+    for (const IntVector4& position : occupied)
+        forward.Remove(position);
+
+    GridFreeCellSet4D backward(gridSize);
+    ea::vector<IntVector4> released;
+    for (unsigned i = 0; i < 200; ++i)
+    {
+        released.push_back(RandomIntVector4(random, gridSize));
+        backward.Remove(released.back());
+    }
+    for (const IntVector4& position : released)
+        backward.Insert(position);
+    for (auto iter = occupied.rbegin(); iter != occupied.rend(); ++iter)
+        backward.Remove(*iter);
+    CHECK(forward.Size() == backward.Size());
+
+    RandomGenerator forwardRandom{ 1 };
+    RandomGenerator backwardRandom{ 1 };
+    for (unsigned i = 0; i < 1000; ++i)
+        CHECK(forward.GetRandomCell(forwardRandom) == backward.GetRandomCell(backwardRandom));
+}
@@ -0,0 +1,70 @@
+#include "GridFreeSpace4D.h"
+#include "TestFramework.h"
+
+#include <EASTL/vector.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+unsigned FlattenIndex(const IntVector4& pos, int gridSize)
+{
+    return static_cast<unsigned>(((pos[3] * gridSize + pos[2]) * gridSize + pos[1]) * gridSize + pos[0]);
+}
+
+/// Compare component sizes of incrementally updated free space with free space rebuilt from scratch.
+void CheckAgainstRebuild(const GridFreeSpace4D& freeSpace, const ea::vector<bool>& freeCells, int gridSize, bool wrapAround)
+{
+    const auto isFree = [&](const IntVector4& position) { return freeCells[FlattenIndex(position, gridSize)]; };
+
+    GridFreeSpace4D reference(gridSize);
+    reference.SetWrapAround(wrapAround);
+    reference.Rebuild(isFree);
+
+    IntVector4 position{};
+    for (unsigned index = 0; index < freeCells.size(); ++index)
+    {
+        CHECK(freeSpace.GetComponentSize(position) == reference.GetComponentSize(position));
+
+        for (int i = 0; i < 4 && ++position[i] == gridSize; ++i)
+            position[i] = 0;
+    }
+}
+
+}
+
+TEST_CASE(GridFreeSpaceMatchesRebuild)
+{
+    RandomGenerator random{ 13 };
+    for (const int gridSize : { 3, 5 })
+    {
+        for (const bool wrapAround : { false, true })
+        {
+            const unsigned numCells = gridSize * gridSize * gridSize * gridSize;
+            ea::vector<bool> freeCells(numCells, true);
+
+            GridFreeSpace4D freeSpace(gridSize);
+            freeSpace.SetWrapAround(wrapAround);
+            CHECK(!freeSpace.IsValid());
+            freeSpace.Rebuild([](const IntVector4&) { return true; });
+            CHECK(freeSpace.IsValid());
+
+            // Occupancy drifts between mostly free and mostly occupied, so components split and merge a lot
+            for (unsigned i = 0; i < 1500; ++i)
+            {
+                const IntVector4 position = RandomIntVector4(random, gridSize);
+                const unsigned occupyPercent = i % 500 < 250 ? 70 : 30;
+                const bool occupy = random.Next(100) < occupyPercent;
+                if (occupy)
+                    freeSpace.Occupy(position);
+                else
+                    freeSpace.Free(position);
+                freeCells[FlattenIndex(position, gridSize)] = !occupy;
+
+                CHECK(freeSpace.IsValid());
+                CheckAgainstRebuild(freeSpace, freeCells, gridSize, wrapAround);
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#include "GameSimulation.h"
+#include "GridHamiltonianCycle4D.h"
+#include "TestFramework.h"
+
+#include <EASTL/vector.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+bool AreAdjacent(const IntVector4& lhs, const IntVector4& rhs)
+{
+    const IntVector4 delta = rhs - lhs;
+    return Abs(delta[0]) + Abs(delta[1]) + Abs(delta[2]) + Abs(delta[3]) == 1;
+}
+
+}
+
+TEST_CASE(HamiltonianCycleVisitsEveryCell)
+{
+    for (int gridSize = 2; gridSize <= 7; ++gridSize)
+    {
+        const GridHamiltonianCycle4D cycle(gridSize);
+        const unsigned numCells = gridSize * gridSize * gridSize * gridSize;
+        const bool odd = gridSize % 2 != 0;
+        CHECK(cycle.HasHole() == odd);
+        CHECK(cycle.GetLength() == (odd ? numCells - 1 : numCells));
+
+        // Walk the whole cycle from a cell that is never the hole
+        const IntVector4 boxBegin{ 0, 0, 0, 0 };
+        const IntVector4 boxEnd{ gridSize, gridSize, gridSize, gridSize };
+        const IntVector4 start{ 1, 1, 1, 1 };
+        ea::vector<bool> visited(numCells);
+        IntVector4 bypassPrevious{};
+        IntVector4 position = start;
+        for (unsigned i = 0; i < cycle.GetLength(); ++i)
+        {
+            const unsigned index = static_cast<unsigned>(FlattenGridIndex(position, gridSize));
+            CHECK(!visited[index]);
+            visited[index] = true;
+            CHECK(cycle.GetDistance(start, position) == i);
+
+            const IntVector4 next = cycle.GetNext(position);
+            CHECK(IsInside(next, boxBegin, boxEnd));
+            CHECK(AreAdjacent(position, next));
+            CHECK(cycle.GetOrder(next) == (cycle.GetOrder(position) + 1) % cycle.GetLength());
+            if (odd && next == cycle.GetBypass())
+                bypassPrevious = position;
+            position = next;
+        }
+        CHECK(position == start);
+
+        if (!odd)
+            continue;
+
+        // Hole is left out and may replace the bypass cell between its neighbors on the cycle
+        const IntVector4& hole = cycle.GetHole();
+        const IntVector4& bypass = cycle.GetBypass();
+        CHECK(hole == boxBegin);
+        CHECK(!visited[FlattenGridIndex(hole, gridSize)]);
+        CHECK(visited[FlattenGridIndex(bypass, gridSize)]);
+        CHECK(AreAdjacent(bypassPrevious, hole));
+        CHECK(AreAdjacent(hole, cycle.GetNext(bypass)));
+        CHECK(cycle.GetOrder(hole) == cycle.GetOrder(bypass));
+    }
+}
+
+TEST_CASE(HamiltonianCycleAutopilotFillsBoard)
+{
+    // Snake following the cycle never traps itself, so it grows until it covers the board, the hole included
+    for (const int gridSize : { 4, 5 })
+    {
+        GameSimulation sim(gridSize);
+        sim.SetLengthIncrement(8);
+        sim.SetAutopilotMode(AutopilotMode::HamiltonianCycle);
+        sim.Reset({}, 3);
+
+        const unsigned maxTicks = 100000;
+        for (unsigned tick = 0; tick < maxTicks && !sim.IsGameOver(); ++tick)
+        {
+            sim.SetNextAction(sim.GetBestAction());
+            sim.Tick();
+        }
+
+        CHECK(sim.IsGameOver());
+        CHECK(sim.GetSnakeLength() == static_cast<unsigned>(gridSize * gridSize * gridSize * gridSize));
+    }
+}
@@ -0,0 +1,97 @@
+#include "GridPointIndex4D.h"
+#include "TestFramework.h"
+
+#include <EASTL/algorithm.h>
+#include <EASTL/vector.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+/// Return nearest cell by Manhattan distance, ties are broken by flattened cell index.
+IntVector4 FindNearestBruteForce(const ea::vector<IntVector4>& points, const IntVector4& position, int gridSize)
+{
+    IntVector4 bestPosition{};
+    int bestDistance = M_MAX_INT;
+    long long bestIndex = 0;
+    for (const IntVector4& point : points)
+    {
+        int distance = 0;
+        for (int i = 0; i < 4; ++i)
+            distance += Abs(point[i] - position[i]);
+
+        const long long index = ((static_cast<long long>(point[3]) * gridSize + point[2]) * gridSize + point[1]) * gridSize + point[0];
+        if (distance < bestDistance || (distance == bestDistance && index < bestIndex))
+        {
+            bestPosition = point;
+            bestDistance = distance;
+            bestIndex = index;
+        }
+    }
+    return bestPosition;
+}
+
+void CheckNearestQueries(const GridPointIndex4D& index, const ea::vector<IntVector4>& points,
+    int gridSize, RandomGenerator& random)
+{
+    CHECK(index.Size() == points.size());
+    for (unsigned i = 0; i < 200; ++i)
+    {
+        // Queries outside of the board are allowed too
+        const IntVector4 offset{ 2, 2, 2, 2 };
+        const IntVector4 position = RandomIntVector4(random, gridSize + 4) - offset;
+        const IntVector4 expected = FindNearestBruteForce(points, position, gridSize);
+        CHECK(index.FindNearest(position) == expected);
+        // Cached answer must be the same
+        CHECK(index.FindNearest(position) == expected);
+    }
+}
+
+}
+
+TEST_CASE(GridPointIndexFindNearest)
+{
+    struct TestConfig
+    {
+        int gridSize_;
+        int binSize_;
+        unsigned maxPoints_;
+    };
+
+    // Configurations cover both direct scan of few cells and ring search over bins
+    const TestConfig configs[] = { { 13, 2, 120 }, { 13, 4, 60 }, { 40, 0, 150 }, { 5, 0, 30 } };
+    RandomGenerator random{ 7 };
+    for (const TestConfig& config : configs)
+    {
+        GridPointIndex4D index(config.gridSize_, config.binSize_);
+        ea::vector<IntVector4> points;
+
+        while (points.size() < config.maxPoints_)
+        {
+            const IntVector4 position = RandomIntVector4(random, config.gridSize_);
+            CHECK(index.Contains(position) == (ea::find(points.begin(), points.end(), position) != points.end()));
+            if (!index.Contains(position))
+            {
+                index.Insert(position);
+                points.push_back(position);
+            }
+
+            if (points.size() % 10 == 1)
+                CheckNearestQueries(index, points, config.gridSize_, random);
+        }
+
+        // Removed cells must not be returned
+        while (points.size() > 1)
+        {
+            const unsigned removedIndex = random.Next(points.size());
+            const IntVector4 removedPosition = points[removedIndex];
+            index.Remove(removedPosition);
+            points.erase(points.begin() + removedIndex);
+            CHECK(!index.Contains(removedPosition));
+
+            if (points.size() % 10 == 1)
+                CheckNearestQueries(index, points, config.gridSize_, random);
+        }
+    }
+}
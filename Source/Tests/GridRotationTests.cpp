@@ -0,0 +1,112 @@
+#include "GameSimulation.h"
+#include "TestFramework.h"
+
+using namespace Urho3D;
+
+namespace
+{
+
+Matrix4 GetRotationMatrix(unsigned index)
+{
+    return GridRotation4D::FromIndex(static_cast<GridRotationIndex>(index)).ToMatrix();
+}
+
+Vector4 GetDirectionVector(unsigned direction)
+{
+    return IntVectorToVector4(DirectionToIntVector(static_cast<GridDirection4D>(direction)));
+}
+
+/// Return determinant of signed permutation matrix.
+int GetDeterminant(const GridRotation4D& rotation)
+{
+    int determinant = 1;
+    for (int i = 0; i < 4; ++i)
+    {
+        determinant *= rotation.signs_[i];
+        for (int j = i + 1; j < 4; ++j)
+            determinant *= rotation.axes_[j] < rotation.axes_[i] ? -1 : 1;
+    }
+    return determinant;
+}
+
+}
+
+TEST_CASE(GridRotationIndicesAreDistinctProperRotations)
+{
+    for (unsigned i = 0; i < NumGridRotations; ++i)
+    {
+        const auto rotation = GridRotation4D::FromIndex(static_cast<GridRotationIndex>(i));
+        CHECK(rotation.ToIndex() == i);
+        CHECK(GetDeterminant(rotation) == 1);
+
+        for (unsigned j = 0; j < i; ++j)
+            CHECK(!GetRotationMatrix(i).Equals(GetRotationMatrix(j)));
+    }
+    CHECK(GetRotationMatrix(IdentityGridRotation).Equals(Matrix4::IDENTITY));
+}
+
+TEST_CASE(GridRotationTablesMatchMatrixMath)
+{
+    for (unsigned i = 0; i < NumGridRotations; ++i)
+    {
+        const Matrix4 matrix = GetRotationMatrix(i);
+
+        for (unsigned j = 0; j < NumGridRotations; ++j)
+        {
+            const auto composed = ComposeRotations(static_cast<GridRotationIndex>(i), static_cast<GridRotationIndex>(j));
+            CHECK(GetRotationMatrix(composed).Equals(matrix * GetRotationMatrix(j)));
+        }
+
+        const auto inverse = InvertRotation(static_cast<GridRotationIndex>(i));
+        CHECK(GetRotationMatrix(inverse).Equals(matrix.Transpose()));
+
+        for (unsigned direction = 0; direction < NumGridDirections; ++direction)
+        {
+            const auto rotated = RotateDirection(static_cast<GridRotationIndex>(i), static_cast<GridDirection4D>(direction));
+            CHECK(GetDirectionVector(rotated).Equals(matrix * GetDirectionVector(direction)));
+        }
+    }
+}
+
+TEST_CASE(GridDeltaRotationsAreQuarterTurns)
+{
+    for (unsigned from = 0; from < NumGridDirections; ++from)
+    {
+        for (unsigned to = 0; to < NumGridDirections; ++to)
+        {
+            const int fromAxis = GetDirectionAxis(static_cast<GridDirection4D>(from));
+            const int toAxis = GetDirectionAxis(static_cast<GridDirection4D>(to));
+            const Matrix4 matrix = GetRotationMatrix(MakeDeltaRotation(static_cast<GridDirection4D>(from), static_cast<GridDirection4D>(to)));
+            if (fromAxis == toAxis)
+            {
+                CHECK(matrix.Equals(Matrix4::IDENTITY));
+                continue;
+            }
+
+            // Quarter turn in the plane of two directions, other axes are kept
+            const float angle = 90.0f * GetDirectionSign(static_cast<GridDirection4D>(from)) * GetDirectionSign(static_cast<GridDirection4D>(to));
+            const Matrix4 expected = fromAxis < toAxis
+                ? Matrix4x5::MakeRotation(fromAxis, toAxis, -angle).rotation_
+                : Matrix4x5::MakeRotation(toAxis, fromAxis, angle).rotation_;
+            CHECK(matrix * GetDirectionVector(from) == GetDirectionVector(to));
+            CHECK(matrix.Equals(expected));
+        }
+    }
+}
+
+TEST_CASE(GridCameraRotationMatchesSmoothRotation)
+{
+    // Renderer blends from previous rotation by float delta, it must end at the rotation from the tables
+    for (unsigned action = 0; action < static_cast<unsigned>(UserAction::Count); ++action)
+    {
+        const RotationDelta4D& delta = GetActionRotation(static_cast<UserAction>(action));
+        const Matrix4 deltaMatrix = delta.AsMatrix(1.0f).rotation_;
+        CHECK(GetRotationMatrix(delta.rotation_).Equals(deltaMatrix));
+
+        for (unsigned i = 0; i < NumGridRotations; ++i)
+        {
+            const auto composed = ComposeRotations(static_cast<GridRotationIndex>(i), delta.rotation_);
+            CHECK(GetRotationMatrix(composed).Equals(GetRotationMatrix(i) * deltaMatrix));
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#include "GridRotation4D.h"
+#include "GridTopology4D.h"
+#include "TestFramework.h"
+
+using namespace Urho3D;
+
+TEST_CASE(GridTopologyStepsBoundedBoard)
+{
+    const int gridSize = 5;
+    const GridTopology4D topology(gridSize);
+    CHECK(!topology.IsWrapAround());
+
+    // Cells outside are kept as is, so the snake may leave the board and step back
+    const IntVector4 corner{ 0, 4, 2, 0 };
+    CHECK(!topology.IsOutside(corner));
+    CHECK(topology.Step(corner, { -1, 0, 0, 0 }) == IntVector4({ -1, 4, 2, 0 }));
+    CHECK(topology.Step(corner, { 0, 1, 0, 0 }) == IntVector4({ 0, 5, 2, 0 }));
+    CHECK(topology.IsOutside({ -1, 4, 2, 0 }));
+    CHECK(topology.IsOutside({ 0, 5, 2, 0 }));
+    CHECK(topology.Step({ -1, 4, 2, 0 }, { 1, 0, 0, 0 }) == corner);
+
+    CHECK(topology.GetDelta({ 0, 0, 0, 0 }, { 4, 0, 0, 0 }) == IntVector4({ 4, 0, 0, 0 }));
+    CHECK(topology.GetDelta({ 4, 0, 0, 0 }, { -1, 0, 0, 0 }) == IntVector4({ -5, 0, 0, 0 }));
+    CHECK(topology.GetDistance({ 0, 0, 0, 0 }, { 4, 4, 4, 4 }) == 16);
+    CHECK(topology.Wrap({ -1, 7, 2, 0 }) == IntVector4({ -1, 7, 2, 0 }));
+}
+
+TEST_CASE(GridTopologyStepsTorus)
+{
+    for (const int gridSize : { 4, 5 })
+    {
+        const GridTopology4D topology(gridSize, true);
+        CHECK(topology.IsWrapAround());
+        CHECK(!topology.IsOutside({ -1, gridSize, 0, 0 }));
+
+        for (int from = 0; from < gridSize; ++from)
+        {
+            // Steps wrap around edges and are undone by the delta
+            for (unsigned i = 0; i < NumGridDirections; ++i)
+            {
+                const IntVector4& offset = DirectionToIntVector(static_cast<GridDirection4D>(i));
+                const IntVector4 position{ from, from, from, from };
+                const IntVector4 next = topology.Step(position, offset);
+                for (int axis = 0; axis < 4; ++axis)
+                    CHECK(next[axis] == (from + offset[axis] + gridSize) % gridSize);
+                CHECK(topology.GetDelta(position, next) == offset);
+            }
+
+            // Delta is the shortest way around, ties on even boards go forward
+            for (int to = 0; to < gridSize; ++to)
+            {
+                const int delta = topology.GetDelta({ from, 0, 0, 0 }, { to, 0, 0, 0 })[0];
+                CHECK(((from + delta) % gridSize + gridSize) % gridSize == to);
+                CHECK(Abs(delta) * 2 <= gridSize);
+                if (Abs(delta) * 2 == gridSize)
+                    CHECK(delta > 0);
+                CHECK(topology.GetDistance({ from, 0, 0, 0 }, { to, 0, 0, 0 }) == Abs(delta));
+            }
+        }
+
+        CHECK(topology.Wrap({ -1, gridSize, -3 * gridSize - 2, 2 * gridSize + 1 })
+            == IntVector4({ gridSize - 1, 0, gridSize - 2, 1 }));
+    }
+}
@@ -0,0 +1,76 @@
+#include "LevelPack.h"
+#include "TestFramework.h"
+
+#include <EASTL/vector.h>
+
+#include <cstdio>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const int gridSize = 7;
+
+/// Snake heads along +Z from the start position, so body is laid along -Z.
+LevelDescription MakeLevel()
+{
+    LevelDescription level;
+    level.size_ = gridSize;
+    level.startPosition_ = { 3, 3, 2, 3 };
+    level.targets_ = { { 3, 3, 5, 3 }, { 0, 0, 0, 0 } };
+    level.obstacles_ = { { 6, 6, 6, 6 }, { 3, 3, 3, 3 }, { 1, 2, 1, 0 } };
+    return level;
+}
+
+}
+
+TEST_CASE(LevelPackRejectsUnplayableLevels)
+{
+    ea::vector<LevelDescription> levels;
+    levels.push_back(MakeLevel());
+
+    // Tail is out of bounds, it would be wrapped on torus and left outside on bounded board
+    levels.push_back(MakeLevel());
+    levels.back().startPosition_ = { 3, 3, 1, 3 };
+
+    // Head is out of bounds
+    levels.push_back(MakeLevel());
+    levels.back().startPosition_ = { 3, 3, 7, 3 };
+
+    // Tail is on obstacle
+    levels.push_back(MakeLevel());
+    levels.back().obstacles_.push_back({ 3, 3, 0, 3 });
+
+    // Target is out of bounds
+    levels.push_back(MakeLevel());
+    levels.back().targets_.push_back({ 3, -1, 3, 3 });
+
+    // Target is on obstacle
+    levels.push_back(MakeLevel());
+    levels.back().targets_.push_back({ 6, 6, 6, 6 });
+
+    const char* fileName = "LevelPackTests.bin";
+    CHECK(LevelPack::Write(fileName, levels));
+
+    LevelPack pack;
+    CHECK(pack.Open(fileName));
+    CHECK(pack.GetNumLevels() == levels.size());
+
+    GameLevel level;
+    CHECK(pack.GetLevel(0, level));
+    CHECK(level.size_ == gridSize);
+    CHECK(level.targets_.size() == 2);
+
+    ea::vector<IntVector4> obstacles;
+    level.obstacles_.ForEach([&](const IntVector4& position) { obstacles.push_back(position); });
+    const ea::vector<IntVector4> expectedObstacles = { { 1, 2, 1, 0 }, { 3, 3, 3, 3 }, { 6, 6, 6, 6 } };
+    CHECK(obstacles == expectedObstacles);
+
+    for (unsigned i = 1; i < levels.size(); ++i)
+        CHECK(!pack.GetLevel(i, level));
+    CHECK(!pack.GetLevel(levels.size(), level));
+
+    pack.Close();
+    remove(fileName);
+}
@@ -0,0 +1,44 @@
+#include "TestFramework.h"
+
+#include <EASTL/algorithm.h>
+#include <EASTL/vector.h>
+
+#include <cstring>
+
+using namespace Urho3D;
+
+/// Usage: Snake4DTests [testName]
+/// Run all registered tests or only the test with given name. Return non-zero if any check fails.
+int main(int argc, char* argv[])
+{
+    // Tests are registered in reverse order
+    ea::vector<TestCase*> testCases;
+    for (TestCase* testCase = GetFirstTestCase(); testCase; testCase = testCase->next_)
+        testCases.push_back(testCase);
+    ea::reverse(testCases.begin(), testCases.end());
+
+    unsigned numTests = 0;
+    unsigned numFailedTests = 0;
+    for (TestCase* testCase : testCases)
+    {
+        if (argc > 1 && strcmp(argv[1], testCase->name_) != 0)
+            continue;
+
+        const unsigned numFailedChecks = GetNumFailedChecks();
+        printf("%s\n", testCase->name_);
+        testCase->function_();
+
+        ++numTests;
+        if (GetNumFailedChecks() != numFailedChecks)
+            ++numFailedTests;
+    }
+
+    if (argc > 1 && numTests == 0)
+    {
+        fprintf(stderr, "Unknown test '%s'\n", argv[1]);
+        return 1;
+    }
+
+    printf("%u of %u tests passed\n", numTests - numFailedTests, numTests);
+    return numFailedTests != 0 ? 1 : 0;
+}
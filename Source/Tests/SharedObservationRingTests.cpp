@@ -0,0 +1,126 @@
+#include "SharedObservationRing.h"
+#include "TestFramework.h"
+
+#include <EASTL/vector.h>
+
+#include <cstring>
+#include <thread>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const char* ringName = "Snake4DTestsObservationRing";
+
+/// Fill the whole tensor and scalars with values derived from observation index.
+void WriteObservation(SharedObservationRing& ring, unsigned long long index)
+{
+    SharedObservationSlot& slot = ring.BeginWrite();
+    slot.scalars_.step_ = static_cast<unsigned>(index);
+    memset(slot.GetTensor(), static_cast<int>(index & 0xff), ring.GetLayout().GetTensorSize());
+    ring.EndWrite();
+}
+
+/// Return whether observation read from the slot is the one with given index and is not torn.
+bool IsObservationConsistent(const ea::vector<unsigned char>& tensor, unsigned step, unsigned long long index)
+{
+    if (step != static_cast<unsigned>(index))
+        return false;
+    for (unsigned char value : tensor)
+    {
+        if (value != (index & 0xff))
+            return false;
+    }
+    return true;
+}
+
+}
+
+TEST_CASE(SharedObservationRingDetectsOverwrittenSlots)
+{
+    ObservationLayout layout;
+    layout.radius_ = 1;
+    const unsigned numSlots = 4;
+
+    SharedObservationRing producer;
+    CHECK(producer.Create(ringName, layout, numSlots));
+    SharedObservationRing consumer;
+    CHECK(consumer.Open(ringName));
+    if (!producer.IsOpen() || !consumer.IsOpen())
+        return;
+
+    CHECK(consumer.GetNumSlots() == numSlots);
+    CHECK(consumer.GetLayout().radius_ == layout.radius_);
+    CHECK(consumer.GetNumPublished() == 0);
+    CHECK(!consumer.BeginRead(0));
+
+    WriteObservation(producer, 0);
+    CHECK(consumer.GetNumPublished() == 1);
+    const SharedObservationSlot* slot = consumer.BeginRead(0);
+    CHECK(slot && slot->scalars_.step_ == 0);
+    CHECK(consumer.EndRead(0));
+    CHECK(!consumer.BeginRead(1));
+
+    // Slot is reused after the ring wraps, reader started before that sees the overwrite
+    slot = consumer.BeginRead(0);
+    CHECK(slot != nullptr);
+    for (unsigned long long index = 1; index <= numSlots; ++index)
+        WriteObservation(producer, index);
+    CHECK(!consumer.EndRead(0));
+    CHECK(!consumer.BeginRead(0));
+
+    slot = consumer.BeginRead(numSlots);
+    CHECK(slot && slot->scalars_.step_ == numSlots);
+    CHECK(consumer.EndRead(numSlots));
+}
+
+TEST_CASE(SharedObservationRingReadsConsistentObservations)
+{
+    // Producer laps the consumer all the time, every read that passes the check must be complete
+    ObservationLayout layout;
+    layout.radius_ = 2;
+    const unsigned numSlots = 2;
+    const unsigned long long numObservations = 20000;
+
+    SharedObservationRing producer;
+    CHECK(producer.Create(ringName, layout, numSlots));
+    SharedObservationRing consumer;
+    CHECK(consumer.Open(ringName));
+    if (!producer.IsOpen() || !consumer.IsOpen())
+        return;
+
+    std::thread producerThread([&]
+    {
+        for (unsigned long long index = 0; index < numObservations; ++index)
+            WriteObservation(producer, index);
+    });
+
+    ea::vector<unsigned char> tensor(layout.GetTensorSize());
+    unsigned numReads = 0;
+    unsigned long long numPublished = 0;
+    while (numPublished < numObservations)
+    {
+        numPublished = consumer.GetNumPublished();
+        if (numPublished == 0)
+            continue;
+
+        const unsigned long long index = numPublished - 1;
+        const SharedObservationSlot* slot = consumer.BeginRead(index);
+        if (!slot)
+            continue;
+
+        const unsigned step = slot->scalars_.step_;
+        memcpy(tensor.data(), slot->GetTensor(), tensor.size());
+        if (consumer.EndRead(index))
+        {
+            CHECK(IsObservationConsistent(tensor, step, index));
+            ++numReads;
+        }
+    }
+    producerThread.join();
+
+    // The last observation is never overwritten
+    CHECK(consumer.BeginRead(numObservations - 1) != nullptr);
+    CHECK(numReads > 0);
+}
@@ -0,0 +1,54 @@
+#include "SimulationBatch.h"
+#include "TestFramework.h"
+
+#include <EASTL/vector.h>
+
+using namespace Urho3D;
+
+TEST_CASE(SimulationBatchMatchesSimulation)
+{
+    // Batch starts with the snake inside the board only if it is large enough
+    const int gridSize = 8;
+    const unsigned numSimulations = 4;
+    const unsigned maxTicks = 1000;
+
+    SimulationBatch batch(gridSize, numSimulations, 0);
+    ea::vector<GameSimulation> sims;
+    for (unsigned i = 0; i < numSimulations; ++i)
+    {
+        batch.Reset(i, i + 1);
+        sims.emplace_back(gridSize);
+        sims.back().Reset({}, i + 1);
+    }
+
+    // Mostly follow the autopilot, so targets are eaten and snakes grow
+    RandomGenerator random{ 13 };
+    ea::vector<UserAction> actions(numSimulations);
+    unsigned maxLength = 0;
+    for (unsigned tick = 0; tick < maxTicks; ++tick)
+    {
+        for (unsigned i = 0; i < numSimulations; ++i)
+        {
+            const bool randomAction = random.Next(4) == 0;
+            actions[i] = randomAction ? static_cast<UserAction>(random.Next(static_cast<unsigned>(UserAction::Count))) : sims[i].GetBestAction();
+            sims[i].SetNextAction(actions[i]);
+            sims[i].Tick();
+        }
+        batch.Step(actions);
+
+        for (unsigned i = 0; i < numSimulations; ++i)
+        {
+            CHECK(batch.IsGameOver(i) == sims[i].IsGameOver());
+            if (sims[i].IsGameOver())
+                continue;
+
+            CHECK(batch.ComputeHash(i) == sims[i].GetHash());
+            CHECK(batch.GetSnakeHead(i) == sims[i].GetSnakeHead());
+            CHECK(batch.GetSnakeLength(i) == sims[i].GetSnakeLength());
+            CHECK(batch.GetTargetPosition(i) == sims[i].GetTargetPosition());
+            maxLength = ea::max(maxLength, sims[i].GetSnakeLength());
+        }
+    }
+
+    CHECK(maxLength > 3);
+}
@@ -0,0 +1,105 @@
+#include "SimulationSnapshot.h"
+#include "TestFramework.h"
+#include "TripleBuffer.h"
+
+#include <thread>
+
+using namespace Urho3D;
+
+namespace
+{
+
+/// Check that snapshot presents the same snake, targets and head validity as the simulation.
+void CheckSnapshot(const SimulationSnapshot& snapshot, const GameSimulation& sim, unsigned long long numTicks)
+{
+    CHECK(snapshot.GetNumTicks() == numTicks);
+    CHECK(snapshot.IsGameOver() == sim.IsGameOver());
+    CHECK(snapshot.GetTargetPositions() == sim.GetTargetPositions());
+
+    const SnakeBody& snake = snapshot.GetSnake();
+    CHECK(snake.Size() == sim.GetSnake().Size());
+    CHECK(snake.GetPreviousSize() == sim.GetSnake().GetPreviousSize());
+    for (unsigned i = 0; i < snake.Size() && i < sim.GetSnake().Size(); ++i)
+        CHECK(snake[i].position_ == sim.GetSnake()[i].position_);
+    for (unsigned i = 0; i < snake.GetPreviousSize() && i < sim.GetSnake().GetPreviousSize(); ++i)
+        CHECK(snake.GetPrevious(i).position_ == sim.GetSnake().GetPrevious(i).position_);
+
+    const int gridSize = sim.GetSize();
+    IntVector4 position{};
+    for (int index = 0; index < gridSize * gridSize * gridSize * gridSize; ++index)
+    {
+        CHECK(snapshot.IsValidHeadPosition(position) == sim.IsValidHeadPosition(position));
+        for (int i = 0; i < 4 && ++position[i] == gridSize; ++i)
+            position[i] = 0;
+    }
+}
+
+}
+
+TEST_CASE(TripleBufferPublishesLatestValue)
+{
+    TripleBuffer<unsigned> buffer;
+    CHECK(!buffer.Update());
+
+    buffer.GetWriteBuffer() = 1;
+    buffer.Publish();
+    buffer.GetWriteBuffer() = 2;
+    buffer.Publish();
+    CHECK(buffer.Update());
+    CHECK(buffer.GetReadBuffer() == 2);
+    CHECK(!buffer.Update());
+    CHECK(buffer.GetReadBuffer() == 2);
+
+    // Consumer on another thread sees increasing values and eventually the last one
+    const unsigned numValues = 100000;
+    std::thread producer([&]
+    {
+        for (unsigned value = 3; value <= numValues; ++value)
+        {
+            buffer.GetWriteBuffer() = value;
+            buffer.Publish();
+        }
+    });
+
+    unsigned lastValue = 2;
+    while (lastValue != numValues)
+    {
+        if (buffer.Update())
+        {
+            CHECK(buffer.GetReadBuffer() > lastValue);
+            lastValue = buffer.GetReadBuffer();
+        }
+    }
+    producer.join();
+    CHECK(!buffer.Update());
+}
+
+TEST_CASE(SimulationSnapshotMatchesSimulation)
+{
+    // Each snapshot buffer is updated every third tick, so incremental snake copy skips ticks
+    const int gridSize = 5;
+    TripleBuffer<SimulationSnapshot> snapshots;
+    GameSimulation sim(gridSize);
+    sim.SetRewindCapacity(16);
+    unsigned long long numTicks = 0;
+
+    for (unsigned game = 0; game < 3; ++game)
+    {
+        sim.Reset({}, game);
+        for (unsigned tick = 0; tick < 300 && !sim.IsGameOver(); ++tick)
+        {
+            sim.SetNextAction(sim.GetBestAction());
+            sim.Tick();
+            ++numTicks;
+
+            // Rewind changes layout of the body, so the next copy is full
+            if (tick % 50 == 49)
+                numTicks -= sim.Rewind(5);
+
+            snapshots.GetWriteBuffer().Update(sim, numTicks);
+            snapshots.Publish();
+            CHECK(snapshots.Update());
+            CheckSnapshot(snapshots.GetReadBuffer(), sim, numTicks);
+        }
+    }
+}
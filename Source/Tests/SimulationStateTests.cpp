@@ -0,0 +1,133 @@
+#include "GameSimulation.h"
+#include "TestFramework.h"
+
+#include <EASTL/vector.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const int gridSize = 7;
+
+/// Play ticks with autopilot and check incremental hash on the way. Stop if the game is over.
+void PlayAutopilot(GameSimulation& sim, unsigned numTicks)
+{
+    for (unsigned i = 0; i < numTicks && !sim.IsGameOver(); ++i)
+    {
+        sim.SetNextAction(sim.GetBestAction());
+        sim.Tick();
+        CHECK(sim.GetHash() == sim.ComputeHash());
+    }
+}
+
+/// Play the same actions in both simulations and check that they stay identical.
+void PlayInLockstep(GameSimulation& lhs, GameSimulation& rhs, unsigned numTicks)
+{
+    for (unsigned i = 0; i < numTicks && !lhs.IsGameOver(); ++i)
+    {
+        const UserAction action = lhs.GetBestAction();
+        lhs.SetNextAction(action);
+        rhs.SetNextAction(action);
+        lhs.Tick();
+        rhs.Tick();
+        CHECK(lhs.GetHash() == lhs.ComputeHash());
+        CHECK(lhs.GetHash() == rhs.GetHash());
+    }
+    CHECK(lhs.IsGameOver() == rhs.IsGameOver());
+}
+
+}
+
+TEST_CASE(SimulationStateRoundTrip)
+{
+    for (const bool wrapAround : { false, true })
+    {
+        GameSimulation sim(gridSize);
+        sim.SetWrapAround(wrapAround);
+        sim.Reset({}, 1);
+        PlayAutopilot(sim, 80);
+        CHECK(!sim.IsGameOver());
+        CHECK(sim.GetSnakeLength() > 3);
+
+        SimulationState state;
+        sim.SaveState(state);
+
+        // Restored simulations have different histories, it must not matter
+        GameSimulation first(gridSize);
+        first.CopySettings(sim);
+        first.Reset({}, 2);
+        PlayAutopilot(first, 10);
+        first.RestoreState(state);
+
+        GameSimulation second(gridSize);
+        second.CopySettings(sim);
+        second.Reset({}, 3);
+        PlayAutopilot(second, 40);
+        second.RestoreState(state);
+
+        CHECK(first.GetHash() == sim.GetHash());
+        CHECK(first.GetHash() == first.ComputeHash());
+        CHECK(first.GetChecksum() == sim.GetChecksum());
+        CHECK(first.GetSnakeLength() == sim.GetSnakeLength());
+        CHECK(second.GetHash() == sim.GetHash());
+
+        SimulationState restoredState;
+        first.SaveState(restoredState);
+        CHECK(restoredState.snakeOffsets_ == state.snakeOffsets_);
+        CHECK(restoredState.targetPositions_ == state.targetPositions_);
+
+        // Restored simulation spawns the same targets as the original one
+        PlayInLockstep(sim, first, 200);
+    }
+}
+
+TEST_CASE(SimulationRewindRoundTrip)
+{
+    const unsigned rewindCapacity = 64;
+    for (const bool wrapAround : { false, true })
+    {
+        GameSimulation sim(gridSize);
+        sim.SetWrapAround(wrapAround);
+        sim.SetRewindCapacity(rewindCapacity);
+        sim.Reset({}, 4);
+
+        ea::vector<UserAction> actions;
+        ea::vector<unsigned long long> hashes{ sim.GetHash() };
+        ea::vector<unsigned> lengths{ sim.GetSnakeLength() };
+        for (unsigned i = 0; i < 150 && !sim.IsGameOver(); ++i)
+        {
+            actions.push_back(sim.GetBestAction());
+            sim.SetNextAction(actions.back());
+            sim.Tick();
+            hashes.push_back(sim.GetHash());
+            lengths.push_back(sim.GetSnakeLength());
+        }
+
+        const unsigned numTicks = actions.size();
+        CHECK(!sim.IsGameOver());
+        CHECK(sim.GetNumRewindableTicks() == rewindCapacity);
+        // Rewound ticks must eat targets, so respawn is undone and replayed too
+        CHECK(lengths[numTicks] > lengths[numTicks - rewindCapacity]);
+
+        CHECK(sim.Rewind(10) == 10);
+        CHECK(sim.GetHash() == hashes[numTicks - 10]);
+        CHECK(sim.GetHash() == sim.ComputeHash());
+        CHECK(sim.GetSnakeLength() == lengths[numTicks - 10]);
+
+        CHECK(sim.Rewind(rewindCapacity) == rewindCapacity - 10);
+        CHECK(sim.Rewind(1) == 0);
+        CHECK(sim.GetHash() == hashes[numTicks - rewindCapacity]);
+        CHECK(sim.GetHash() == sim.ComputeHash());
+        CHECK(sim.GetSnakeLength() == lengths[numTicks - rewindCapacity]);
+
+        // Replaying the same actions must reproduce the original game
+        for (unsigned tick = numTicks - rewindCapacity; tick < numTicks; ++tick)
+        {
+            sim.SetNextAction(actions[tick]);
+            sim.Tick();
+            CHECK(sim.GetHash() == hashes[tick + 1]);
+            CHECK(sim.GetHash() == sim.ComputeHash());
+        }
+    }
+}
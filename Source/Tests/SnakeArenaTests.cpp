@@ -0,0 +1,112 @@
+#include "GameSimulation.h"
+#include "SnakeArena.h"
+#include "TestFramework.h"
+
+#include <EASTL/vector.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+/// Return action of the simulation that moves the head into the cell, None if no turn does.
+UserAction GetActionToCell(const GameSimulation& sim, const IntVector4& position)
+{
+    const GridRotationIndex cameraRotation = sim.GetCamera().GetCurrentRotation();
+    for (unsigned i = 0; i < static_cast<unsigned>(UserAction::Count); ++i)
+    {
+        const auto action = static_cast<UserAction>(i);
+        const GridRotationIndex rotation = ComposeRotations(cameraRotation, GetActionRotation(action).rotation_);
+        const GridDirection4D heading = RotateDirection(rotation, MakeGridDirection(2, 1));
+        if (sim.GetTopology().Step(sim.GetSnakeHead(), DirectionToIntVector(heading)) == position)
+            return action;
+    }
+    return UserAction::None;
+}
+
+/// Return start rotation that heads the snake along the direction.
+GridRotationIndex GetStartRotation(GridDirection4D heading)
+{
+    for (unsigned i = 0; i < NumGridRotations; ++i)
+    {
+        const auto rotation = static_cast<GridRotationIndex>(i);
+        if (RotateDirection(rotation, MakeGridDirection(2, 1)) == heading)
+            return rotation;
+    }
+    return IdentityGridRotation;
+}
+
+void CheckSameSnake(const SnakeArena& arena, const GameSimulation& sim)
+{
+    const ea::deque<IntVector4>& body = arena.GetSnakeBody(0);
+    CHECK(body.size() == sim.GetSnakeLength());
+    for (unsigned i = 0; i < body.size() && i < sim.GetSnakeLength(); ++i)
+        CHECK(body[i] == sim.GetSnake()[i].position_);
+    CHECK(arena.GetTargets() == sim.GetTargetPositions());
+}
+
+}
+
+TEST_CASE(SnakeArenaMatchesSimulation)
+{
+    // Single arena snake is driven by arena AI, its moves are replayed by the simulation.
+    // Snake grows fast on small board, so it eventually dies.
+    const int gridSize = 5;
+    const unsigned lengthIncrement = 5;
+    const unsigned maxTicks = 1000;
+    unsigned maxLength = 0;
+    for (const bool wrapAround : { false, true })
+    {
+        for (unsigned long long seed = 0; seed < 4; ++seed)
+        {
+            // Targets are recorded by the first run, so the simulation spawns them from predefined list in the same order
+            SnakeArena recorder(gridSize, 1, 1, seed);
+            recorder.SetWrapAround(wrapAround);
+            recorder.SetLengthIncrement(lengthIncrement);
+            recorder.Reset(seed);
+            ea::vector<IntVector4> targets = recorder.GetTargets();
+            for (unsigned tick = 0; tick < maxTicks && recorder.IsAlive(0) && !recorder.GetTargets().empty(); ++tick)
+            {
+                recorder.Tick();
+                if (!recorder.GetTargets().empty() && recorder.GetTargets()[0] != targets.back())
+                    targets.push_back(recorder.GetTargets()[0]);
+            }
+
+            SnakeArena arena(gridSize, 1, 1, seed);
+            arena.SetWrapAround(wrapAround);
+            arena.SetLengthIncrement(lengthIncrement);
+            arena.Reset(seed);
+
+            GameLevel level;
+            level.size_ = gridSize;
+            level.startPosition_ = arena.GetSnakeHead(0);
+            level.startRotation_ = GetStartRotation(arena.GetSnakeHeading(0));
+
+            GameSimulation sim(gridSize);
+            sim.SetWrapAround(wrapAround);
+            sim.SetLengthIncrement(lengthIncrement);
+            sim.SetUpdateBestAction(false);
+            sim.SetLevel(level);
+            sim.Reset(targets);
+            CheckSameSnake(arena, sim);
+
+            for (unsigned tick = 0; tick < maxTicks && arena.IsAlive(0) && !arena.GetTargets().empty(); ++tick)
+            {
+                arena.Tick();
+                sim.SetNextAction(GetActionToCell(sim, arena.GetLastMove(0)));
+                sim.Tick();
+
+                CHECK(arena.IsAlive(0) == !sim.IsGameOver());
+                if (arena.IsAlive(0))
+                {
+                    CHECK(sim.GetSnakeHead() == arena.GetLastMove(0));
+                    CheckSameSnake(arena, sim);
+                    maxLength = ea::max(maxLength, arena.GetSnakeLength(0));
+                }
+            }
+        }
+    }
+
+    // Snakes have eaten some targets
+    CHECK(maxLength > 3);
+}
@@ -0,0 +1,114 @@
+#include "GameSimulation.h"
+#include "TestFramework.h"
+
+#include <EASTL/deque.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+SnakeElement MakeElement(int x)
+{
+    SnakeElement element;
+    element.position_ = { x, 0, 0, 0 };
+    return element;
+}
+
+/// Check current and previous state of the body against reference positions along X.
+void CheckBody(const SnakeBody& body, const ea::deque<int>& current, const ea::deque<int>& previous)
+{
+    CHECK(body.Size() == current.size());
+    CHECK(body.GetPreviousSize() == previous.size());
+    for (unsigned i = 0; i < body.Size() && i < current.size(); ++i)
+        CHECK(body[i].position_[0] == current[i]);
+    for (unsigned i = 0; i < body.GetPreviousSize() && i < previous.size(); ++i)
+        CHECK(body.GetPrevious(i).position_[0] == previous[i]);
+}
+
+/// Check that bodies have equal current and previous states.
+void CheckSameBody(const SnakeBody& lhs, const SnakeBody& rhs)
+{
+    CHECK(lhs.Size() == rhs.Size());
+    CHECK(lhs.GetPreviousSize() == rhs.GetPreviousSize());
+    for (unsigned i = 0; i < lhs.Size() && i < rhs.Size(); ++i)
+        CHECK(lhs[i].position_ == rhs[i].position_);
+    for (unsigned i = 0; i < lhs.GetPreviousSize() && i < rhs.GetPreviousSize(); ++i)
+        CHECK(lhs.GetPrevious(i).position_ == rhs.GetPrevious(i).position_);
+}
+
+}
+
+TEST_CASE(SnakeBodyKeepsPreviousState)
+{
+    SnakeBody body;
+    ea::deque<int> current;
+    for (int x = 0; x < 3; ++x)
+    {
+        body.PushBack(MakeElement(x));
+        current.push_back(x);
+    }
+    body.CommitState();
+    ea::deque<int> previous = current;
+    CheckBody(body, current, previous);
+
+    // Snake grows on every third tick, storage is reallocated several times while previous state is kept
+    for (int tick = 1; tick <= 100; ++tick)
+    {
+        body.CommitState();
+        previous = current;
+
+        body.PushFront(MakeElement(-tick));
+        current.push_front(-tick);
+        CheckBody(body, current, previous);
+
+        if (tick % 3 != 0)
+        {
+            body.PopBack();
+            current.pop_back();
+        }
+        CheckBody(body, current, previous);
+    }
+
+    // Undone head collapses previous state into current one
+    body.PopFront();
+    current.pop_front();
+    CheckBody(body, current, current);
+}
+
+TEST_CASE(SnakeBodyCopiesIncrementally)
+{
+    SnakeBody source;
+    for (int x = 0; x < 3; ++x)
+        source.PushBack(MakeElement(x));
+    source.CommitState();
+
+    // Each copy is updated every third tick, like buffers of TripleBuffer
+    SnakeBody copies[3];
+    for (int tick = 1; tick <= 200; ++tick)
+    {
+        source.CommitState();
+        source.PushFront(MakeElement(-tick));
+        if (tick % 4 != 0)
+            source.PopBack();
+
+        // Changes of layout force full copy
+        if (tick % 50 == 0)
+            source.PopFront();
+        if (tick % 70 == 0)
+        {
+            source.Clear();
+            for (int x = 0; x < 3; ++x)
+                source.PushBack(MakeElement(tick + x));
+            source.CommitState();
+        }
+
+        SnakeBody& copy = copies[tick % 3];
+        copy.CopyFrom(source);
+        CheckSameBody(copy, source);
+    }
+
+    SnakeBody freshCopy;
+    freshCopy.CopyFrom(source);
+    CheckSameBody(freshCopy, source);
+}
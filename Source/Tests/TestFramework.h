@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdio>
+
+namespace Urho3D
+{
+
+using TestFunction = void(*)();
+
+/// Test registered by TEST_CASE.
+struct TestCase
+{
+    const char* name_{};
+    TestFunction function_{};
+    TestCase* next_{};
+};
+
+/// Return head of the list of registered tests.
+inline TestCase*& GetFirstTestCase()
+{
+    static TestCase* firstTestCase = nullptr;
+    return firstTestCase;
+}
+
+/// Return number of failed checks of all tests.
+inline unsigned& GetNumFailedChecks()
+{
+    static unsigned numFailedChecks = 0;
+    return numFailedChecks;
+}
+
+/// Adds test to the list on static initialization.
+struct TestRegistration
+{
+    TestRegistration(TestCase& testCase)
+    {
+        testCase.next_ = GetFirstTestCase();
+        GetFirstTestCase() = &testCase;
+    }
+};
+
+/// Report failed check and keep running the test.
+inline void ReportFailedCheck(const char* expression, const char* file, int line)
+{
+    fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+    ++GetNumFailedChecks();
+}
+
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static Urho3D::TestCase name##TestCase{ #name, name }; \
+    static const Urho3D::TestRegistration name##Registration{ name##TestCase }; \
+    static void name()
+
+#define CHECK(expression) \
+    ((expression) ? (void)0 : Urho3D::ReportFailedCheck(#expression, __FILE__, __LINE__))
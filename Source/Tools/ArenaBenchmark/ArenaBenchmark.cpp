@@ -0,0 +1,80 @@
+#include "SnakeArena.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Urho3D;
+
+namespace
+{
+
+unsigned ParseArgument(int argc, char* argv[], int index, unsigned defaultValue)
+{
+    return index < argc ? static_cast<unsigned>(strtoul(argv[index], nullptr, 10)) : defaultValue;
+}
+
+/// Hash of all snake heads and targets, equal for equal arena states.
+unsigned long long CalculateChecksum(const SnakeArena& arena)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    const auto addValue = [&](int value)
+    {
+        hash ^= static_cast<unsigned>(value);
+        hash *= 1099511628211ull;
+    };
+
+    for (unsigned i = 0; i < arena.GetNumSnakes(); ++i)
+    {
+        addValue(arena.IsAlive(i));
+        addValue(arena.GetSnakeLength(i));
+        if (arena.IsAlive(i))
+        {
+            for (int coordinate : arena.GetSnakeHead(i))
+                addValue(coordinate);
+        }
+    }
+    for (const IntVector4& target : arena.GetTargets())
+    {
+        for (int coordinate : target)
+            addValue(coordinate);
+    }
+    return hash;
+}
+
+}
+
+/// Usage: ArenaBenchmark [numSnakes] [gridSize] [numThreads] [numTicks]
+int main(int argc, char* argv[])
+{
+    const unsigned hardwareThreads = ea::max(1u, std::thread::hardware_concurrency());
+    const unsigned numSnakes = ea::max(1u, ParseArgument(argc, argv, 1, 16));
+    const int gridSize = static_cast<int>(ea::max(2u, ParseArgument(argc, argv, 2, 21)));
+    const unsigned numThreads = ea::max(1u, ParseArgument(argc, argv, 3, hardwareThreads));
+    const unsigned numTicks = ParseArgument(argc, argv, 4, 500);
+
+    SnakeArena arena(gridSize, numSnakes, numSnakes, 0);
+    WorkerPool pool(numThreads - 1);
+
+    printf("Running %u snakes on board of size %d on %u threads for %u ticks\n",
+        numSnakes, gridSize, pool.GetNumThreads(), numTicks);
+
+    using Clock = std::chrono::steady_clock;
+    const auto startTime = Clock::now();
+    for (unsigned i = 0; i < numTicks; ++i)
+        arena.Tick(pool);
+    const double elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    unsigned totalLength = 0;
+    unsigned totalDeaths = 0;
+    for (unsigned i = 0; i < numSnakes; ++i)
+    {
+        totalLength += arena.GetSnakeLength(i);
+        totalDeaths += arena.GetNumDeaths(i);
+    }
+
+    printf("%.3f ms per tick, total length %u, deaths %u\n", elapsed * 1000.0 / ea::max(1u, numTicks), totalLength, totalDeaths);
+    // Checksum must not depend on the number of threads
+    printf("Checksum %016llx\n", CalculateChecksum(arena));
+    return 0;
+}
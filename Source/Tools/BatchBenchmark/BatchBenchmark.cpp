@@ -0,0 +1,61 @@
+#include "SimulationBatch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const int gridSize = 11;
+/// Number of pre-generated action sets to cycle through.
+const unsigned numActionFrames = 64;
+
+unsigned ParseArgument(int argc, char* argv[], int index, unsigned defaultValue)
+{
+    return index < argc ? static_cast<unsigned>(strtoul(argv[index], nullptr, 10)) : defaultValue;
+}
+
+}
+
+/// Usage: BatchBenchmark [numSimulations] [numThreads] [seconds]
+int main(int argc, char* argv[])
+{
+    const unsigned hardwareThreads = ea::max(1u, std::thread::hardware_concurrency());
+    const unsigned numSimulations = ea::max(1u, ParseArgument(argc, argv, 1, 4096));
+    const unsigned numThreads = ea::max(1u, ParseArgument(argc, argv, 2, hardwareThreads));
+    const unsigned duration = ParseArgument(argc, argv, 3, 5);
+
+    SimulationBatch batch(gridSize, numSimulations, 0);
+    batch.SetAutoReset(true);
+    WorkerPool pool(numThreads - 1);
+
+    // Random actions are generated in advance so only stepping is measured
+    RandomGenerator random(0);
+    ea::vector<UserAction> actions(numActionFrames * numSimulations);
+    for (UserAction& action : actions)
+        action = static_cast<UserAction>(random.Next(static_cast<unsigned>(UserAction::Count)));
+
+    printf("Stepping %u simulations of size %d on %u threads for %u s\n",
+        numSimulations, gridSize, pool.GetNumThreads(), duration);
+
+    using Clock = std::chrono::steady_clock;
+    const auto startTime = Clock::now();
+    const auto endTime = startTime + std::chrono::seconds(duration);
+
+    unsigned long long numSteps = 0;
+    unsigned frame = 0;
+    while (Clock::now() < endTime)
+    {
+        const ea::span<const UserAction> frameActions{ &actions[frame * numSimulations], numSimulations };
+        batch.Step(frameActions, pool);
+        numSteps += numSimulations;
+        frame = (frame + 1) % numActionFrames;
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
+    printf("%llu steps in %.2f s: %.0f steps per second\n", numSteps, elapsed, numSteps / elapsed);
+    return 0;
+}
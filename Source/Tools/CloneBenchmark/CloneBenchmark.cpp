@@ -0,0 +1,100 @@
+#include "GameSimulation.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const int gridSize = 11;
+
+/// Boards where restore rate is compared, the largest one is sparse.
+const int restoreGridSizes[] = { gridSize, 21, 41, 81 };
+/// Max ratio of restore rates on different boards. Restore is O(snake length), so rates differ only by noise.
+const double maxRestoreRateRatio = 3.0;
+
+using Clock = std::chrono::steady_clock;
+
+/// Call function repeatedly for given time and return number of calls per second.
+template <class T>
+double MeasureRate(double duration, const T& function)
+{
+    const auto startTime = Clock::now();
+    const auto endTime = startTime + std::chrono::duration<double>(duration);
+
+    unsigned long long numCalls = 0;
+    while (Clock::now() < endTime)
+    {
+        for (unsigned i = 0; i < 16; ++i)
+            function();
+        numCalls += 16;
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
+    return numCalls / elapsed;
+}
+
+/// Let autopilot grow the snake.
+void GrowSnake(GameSimulation& sim, unsigned snakeLength)
+{
+    sim.Reset({}, 0);
+    while (sim.GetSnakeLength() < snakeLength && !sim.IsGameOver())
+    {
+        sim.SetNextAction(sim.GetBestAction());
+        sim.Tick();
+    }
+}
+
+}
+
+/// Usage: CloneBenchmark [snakeLength] [seconds]
+int main(int argc, char* argv[])
+{
+    const unsigned snakeLength = argc > 1 ? static_cast<unsigned>(strtoul(argv[1], nullptr, 10)) : 100;
+    const double duration = argc > 2 ? strtod(argv[2], nullptr) : 2.0;
+
+    GameSimulation sim(gridSize);
+    GrowSnake(sim, snakeLength);
+    printf("Snake length %u\n", sim.GetSnakeLength());
+
+    SimulationState state;
+    sim.SaveState(state);
+    const double saveRate = MeasureRate(duration, [&] { sim.SaveState(state); });
+    printf("SaveState: %.0f per second\n", saveRate);
+
+    GameSimulation clone(gridSize);
+    const double restoreRate = MeasureRate(duration, [&] { clone.RestoreState(state); });
+    printf("RestoreState: %.0f per second\n", restoreRate);
+
+    const double copyRate = MeasureRate(duration, [&] { clone = sim; });
+    printf("Full GameSimulation copy: %.0f per second\n", copyRate);
+
+    // Monte Carlo planner restores the root state on every iteration, so restore must not depend on board size
+    double minRestoreRate = restoreRate;
+    double maxRestoreRate = restoreRate;
+    for (const int restoreGridSize : restoreGridSizes)
+    {
+        GameSimulation boardSim(restoreGridSize);
+        GrowSnake(boardSim, snakeLength);
+        SimulationState boardState;
+        boardSim.SaveState(boardState);
+
+        GameSimulation boardClone(restoreGridSize);
+        const double boardRestoreRate = MeasureRate(duration, [&] { boardClone.RestoreState(boardState); });
+        printf("RestoreState on board %d with snake length %u: %.0f per second\n",
+            restoreGridSize, boardSim.GetSnakeLength(), boardRestoreRate);
+
+        minRestoreRate = ea::min(minRestoreRate, boardRestoreRate);
+        maxRestoreRate = ea::max(maxRestoreRate, boardRestoreRate);
+    }
+
+    if (maxRestoreRate > minRestoreRate * maxRestoreRateRatio)
+    {
+        printf("RestoreState rate depends on board size\n");
+        return 1;
+    }
+    return 0;
+}
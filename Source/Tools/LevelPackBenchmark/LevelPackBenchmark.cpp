@@ -0,0 +1,149 @@
+#include "GameSimulation.h"
+#include "LevelPack.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const unsigned numTargets = 4;
+/// Percentage of cells occupied by obstacles.
+const unsigned obstacleDensity = 5;
+/// Number of cells ahead of the snake kept free of obstacles.
+const int startClearance = 3;
+
+using Clock = std::chrono::steady_clock;
+
+unsigned ParseArgument(int argc, char* argv[], int index, unsigned defaultValue)
+{
+    return index < argc ? static_cast<unsigned>(strtoul(argv[index], nullptr, 10)) : defaultValue;
+}
+
+double GetElapsed(Clock::time_point startTime)
+{
+    return std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+/// Generate level with random start pose, targets and obstacles.
+LevelDescription GenerateLevel(int gridSize, unsigned long long seed)
+{
+    RandomGenerator random(seed);
+
+    LevelDescription level;
+    level.size_ = gridSize;
+    level.startRotation_ = static_cast<GridRotationIndex>(random.Next(NumGridRotations));
+    for (int i = 0; i < 4; ++i)
+        level.startPosition_[i] = startClearance + static_cast<int>(random.Next(gridSize - 2 * startClearance));
+
+    // Keep snake body and cells in front of it free
+    const IntVector4& direction = DirectionToIntVector(RotateDirection(level.startRotation_, MakeGridDirection(2, 1)));
+    const auto isReserved = [&](const IntVector4& position)
+    {
+        for (int i = -2; i <= startClearance; ++i)
+        {
+            if (position == level.startPosition_ + i * direction)
+                return true;
+        }
+        return ea::find(level.targets_.begin(), level.targets_.end(), position) != level.targets_.end();
+    };
+
+    while (level.targets_.size() < numTargets)
+    {
+        const IntVector4 position = RandomIntVector4(random, gridSize);
+        if (!isReserved(position))
+            level.targets_.push_back(position);
+    }
+
+    const auto size = static_cast<unsigned>(gridSize);
+    const unsigned numObstacles = size * size * size * size * obstacleDensity / 100;
+    for (unsigned i = 0; i < numObstacles; ++i)
+    {
+        const IntVector4 position = RandomIntVector4(random, gridSize);
+        if (!isReserved(position))
+            level.obstacles_.push_back(position);
+    }
+    return level;
+}
+
+}
+
+/// Usage: LevelPackBenchmark [fileName] [numLevels] [gridSize] [numTicks]
+int main(int argc, char* argv[])
+{
+    const ea::string fileName = argc > 1 ? argv[1] : "Levels.bin";
+    const unsigned numLevels = ea::max(1u, ParseArgument(argc, argv, 2, 10000));
+    const int gridSize = static_cast<int>(ea::max(2u * startClearance + 1, ParseArgument(argc, argv, 3, 11)));
+    const unsigned numTicks = ParseArgument(argc, argv, 4, 100);
+
+    // Generate and write the pack
+    {
+        ea::vector<LevelDescription> levels;
+        for (unsigned i = 0; i < numLevels; ++i)
+            levels.push_back(GenerateLevel(gridSize, i));
+
+        if (!LevelPack::Write(fileName, levels))
+        {
+            fprintf(stderr, "Cannot write level pack '%s'\n", fileName.c_str());
+            return 1;
+        }
+    }
+
+    // Open the pack and access every level
+    const auto openTime = Clock::now();
+    LevelPack pack;
+    if (!pack.Open(fileName))
+    {
+        fprintf(stderr, "Cannot open level pack '%s'\n", fileName.c_str());
+        return 1;
+    }
+    const double openElapsed = GetElapsed(openTime);
+
+    const auto accessTime = Clock::now();
+    unsigned long long levelsHash = 0;
+    for (unsigned i = 0; i < pack.GetNumLevels(); ++i)
+    {
+        GameLevel level;
+        if (!pack.GetLevel(i, level))
+        {
+            fprintf(stderr, "Level %u is corrupted\n", i);
+            return 1;
+        }
+        levelsHash ^= level.hash_;
+    }
+    const double accessElapsed = GetElapsed(accessTime);
+
+    printf("Opened %u levels of size %d in %.3f ms, accessed all in %.3f ms\n",
+        pack.GetNumLevels(), gridSize, openElapsed * 1000.0, accessElapsed * 1000.0);
+
+    // Play every level with autopilot, snake must never enter obstacles
+    GameSimulation sim(gridSize);
+    const auto playTime = Clock::now();
+    unsigned long long totalTicks = 0;
+    unsigned totalLength = 0;
+    unsigned numCollisions = 0;
+    for (unsigned i = 0; i < pack.GetNumLevels(); ++i)
+    {
+        GameLevel level;
+        pack.GetLevel(i, level);
+        sim.StartLevel(level, i);
+        for (unsigned tick = 0; tick < numTicks && !sim.IsGameOver(); ++tick)
+        {
+            sim.SetNextAction(sim.GetBestAction());
+            sim.Tick();
+            ++totalTicks;
+            if (!sim.IsOutside(sim.GetSnakeHead()) && level.obstacles_.Contains(sim.GetSnakeHead()))
+                ++numCollisions;
+        }
+        totalLength += sim.GetSnakeLength();
+    }
+    const double playElapsed = GetElapsed(playTime);
+
+    printf("Played %llu ticks in %.3f s, average length %.1f, obstacle collisions %u\n",
+        totalTicks, playElapsed, static_cast<double>(totalLength) / pack.GetNumLevels(), numCollisions);
+    printf("Levels hash %016llx\n", levelsHash);
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "SharedObservationRing.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const int gridSize = 11;
+const unsigned numSlots = 64;
+
+using Clock = std::chrono::steady_clock;
+
+/// Play the game with built-in autopilot and publish observation of every tick.
+int Produce(const ea::string& name, unsigned duration)
+{
+    SharedObservationRing ring;
+    if (!ring.Create(name, ObservationLayout{}, numSlots))
+    {
+        fprintf(stderr, "Cannot create shared memory '%s'\n", name.c_str());
+        return 1;
+    }
+
+    GameSimulation sim(gridSize);
+    unsigned long long seed = 0;
+    unsigned step = 0;
+
+    const auto startTime = Clock::now();
+    const auto endTime = startTime + std::chrono::seconds(duration);
+    while (Clock::now() < endTime)
+    {
+        SharedObservationSlot& slot = ring.BeginWrite();
+        EncodeObservation(sim, ring.GetLayout(), step, slot.scalars_, slot.GetTensor());
+        ring.EndWrite();
+
+        if (sim.IsGameOver())
+        {
+            sim.Reset({}, ++seed);
+            step = 0;
+        }
+        else
+        {
+            sim.SetNextAction(sim.GetBestAction());
+            sim.Tick();
+            ++step;
+        }
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
+    const unsigned long long numPublished = ring.GetNumPublished();
+    printf("Published %llu observations in %.2f s: %.0f per second\n", numPublished, elapsed, numPublished / elapsed);
+    return 0;
+}
+
+/// Read observations in place as they are published and validate them.
+int Consume(const ea::string& name, unsigned duration)
+{
+    SharedObservationRing ring;
+    const auto openDeadline = Clock::now() + std::chrono::seconds(5);
+    while (!ring.Open(name))
+    {
+        if (Clock::now() > openDeadline)
+        {
+            fprintf(stderr, "Cannot open shared memory '%s'\n", name.c_str());
+            return 1;
+        }
+    }
+
+    const ObservationLayout layout = ring.GetLayout();
+    const unsigned channelSize = layout.GetChannelSize();
+    const unsigned snakeChannel = static_cast<unsigned>(ObservationChannel::Snake) * channelSize;
+    const unsigned headCell = channelSize / 2;
+
+    unsigned long long nextIndex = ring.GetNumPublished();
+    unsigned long long numRead = 0;
+    unsigned long long numDropped = 0;
+    unsigned long long numInvalid = 0;
+    unsigned maxLength = 0;
+
+    const auto startTime = Clock::now();
+    const auto endTime = startTime + std::chrono::seconds(duration);
+    while (Clock::now() < endTime)
+    {
+        const unsigned long long numPublished = ring.GetNumPublished();
+        if (nextIndex >= numPublished)
+            continue;
+
+        // Skip observations that were already overwritten
+        if (numPublished - nextIndex > ring.GetNumSlots())
+        {
+            const unsigned long long newIndex = numPublished - ring.GetNumSlots();
+            numDropped += newIndex - nextIndex;
+            nextIndex = newIndex;
+        }
+
+        const SharedObservationSlot* slot = ring.BeginRead(nextIndex);
+        if (slot)
+        {
+            const unsigned char* tensor = slot->GetTensor();
+            const unsigned snakeLength = slot->scalars_.snakeLength_;
+            const bool gameOver = !!slot->scalars_.gameOver_;
+            const bool headVisible = !!tensor[snakeChannel + headCell];
+
+            if (ring.EndRead(nextIndex))
+            {
+                ++numRead;
+                maxLength = ea::max(maxLength, snakeLength);
+                if (!gameOver && !headVisible)
+                    ++numInvalid;
+                ++nextIndex;
+                continue;
+            }
+        }
+
+        ++numDropped;
+        ++nextIndex;
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
+    printf("Read %llu observations in %.2f s: %.0f per second, %llu dropped, %llu invalid, max length %u\n",
+        numRead, elapsed, numRead / elapsed, numDropped, numInvalid, maxLength);
+    return numInvalid == 0 ? 0 : 1;
+}
+
+}
+
+/// Usage: ObservationExport produce|consume [name] [seconds]
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: ObservationExport produce|consume [name] [seconds]\n");
+        return 1;
+    }
+
+    const ea::string name = argc > 2 ? argv[2] : "Snake4DObservations";
+    const unsigned duration = argc > 3 ? static_cast<unsigned>(strtoul(argv[3], nullptr, 10)) : 10;
+
+    if (strcmp(argv[1], "produce") == 0)
+        return Produce(name, duration);
+    else if (strcmp(argv[1], "consume") == 0)
+        return Consume(name, duration);
+
+    fprintf(stderr, "Unknown mode '%s'\n", argv[1]);
+    return 1;
+}
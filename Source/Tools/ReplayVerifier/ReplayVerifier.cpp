@@ -0,0 +1,81 @@
+#include "GameReplay.h"
+#include "LevelPack.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Urho3D;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+double GetElapsed(Clock::time_point startTime)
+{
+    return std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+}
+
+/// Usage: ReplayVerifier replayFile [levelPackFile levelIndex]
+/// Replay the game as fast as possible and report the first tick where simulation diverges from the recording.
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: ReplayVerifier replayFile [levelPackFile levelIndex]\n");
+        return 1;
+    }
+
+    GameReplay replay;
+    if (!replay.Load(argv[1]))
+    {
+        fprintf(stderr, "Cannot load replay '%s'\n", argv[1]);
+        return 1;
+    }
+
+    const ReplayHeader& header = replay.GetHeader();
+    GameSimulation sim(header.gridSize_);
+
+    // Level pack must stay open while the level is used
+    LevelPack pack;
+    if (argc > 3)
+    {
+        GameLevel level;
+        const auto levelIndex = static_cast<unsigned>(strtoul(argv[3], nullptr, 10));
+        if (!pack.Open(argv[2]) || !pack.GetLevel(levelIndex, level))
+        {
+            fprintf(stderr, "Cannot load level %u from level pack '%s'\n", levelIndex, argv[2]);
+            return 1;
+        }
+        sim.SetLevel(level);
+    }
+
+    if (!replay.StartPlayback(sim))
+    {
+        fprintf(stderr, "Replay is recorded on another board or level\n");
+        return 1;
+    }
+
+    // Autopilot is not used by playback
+    sim.SetUpdateBestAction(false);
+
+    const auto startTime = Clock::now();
+    const unsigned long long numTicks = replay.GetNumTicks();
+    const unsigned long long divergentTick = replay.PlayAndVerify(sim, 0, numTicks);
+    const double elapsed = GetElapsed(startTime);
+
+    printf("Played %llu of %llu ticks in %.3f ms: %.0f ticks per second\n", ea::min(divergentTick + 1, numTicks), numTicks,
+        elapsed * 1000.0, ea::min(divergentTick + 1, numTicks) / ea::max(elapsed, 1e-9));
+    if (divergentTick < numTicks)
+    {
+        printf("Diverged at tick %llu: checksum %04x, recorded %04x\n",
+            divergentTick, sim.GetChecksum(), replay.GetChecksum(divergentTick));
+        return 2;
+    }
+
+    printf("No divergence, final score %u\n", sim.GetSnakeLength());
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include "MonteCarloPlanner.h"
+#include "WorkerPool.h"
+
+#include <EASTL/sort.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Urho3D;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+/// AI that plays the games.
+enum class PlayerType
+{
+    /// Built-in path finder autopilot.
+    PathFinder,
+    /// Hamiltonian cycle autopilot, same as perfect play of demo game.
+    Perfect,
+    /// Tree search on top of path finder, same as demo game.
+    Planner
+};
+
+enum class GameOutcome
+{
+    /// Board is filled up to the last target.
+    Won,
+    Died,
+    /// Tick limit is reached.
+    Stopped
+};
+
+struct GameResult
+{
+    unsigned score_{};
+    unsigned numTicks_{};
+    GameOutcome outcome_{};
+    /// Time spent on choosing actions.
+    double decisionTime_{};
+    double maxDecisionTime_{};
+};
+
+unsigned ParseArgument(int argc, char* argv[], int index, unsigned defaultValue)
+{
+    return index < argc ? static_cast<unsigned>(strtoul(argv[index], nullptr, 10)) : defaultValue;
+}
+
+bool ParsePlayerType(const char* name, PlayerType& playerType)
+{
+    if (strcmp(name, "pathfinder") == 0)
+        playerType = PlayerType::PathFinder;
+    else if (strcmp(name, "perfect") == 0)
+        playerType = PlayerType::Perfect;
+    else if (strcmp(name, "planner") == 0)
+        playerType = PlayerType::Planner;
+    else
+        return false;
+    return true;
+}
+
+double GetElapsed(Clock::time_point startTime)
+{
+    return std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+/// Play single game from start to end as fast as possible.
+GameResult PlayGame(PlayerType playerType, int gridSize, bool wrapAround, unsigned long long seed, unsigned maxTicks, float timeBudget)
+{
+    GameSimulation sim(gridSize);
+    // Actions are estimated explicitly so their cost is measured apart from ticks
+    sim.SetUpdateBestAction(false);
+    sim.SetWrapAround(wrapAround);
+    if (playerType == PlayerType::Perfect)
+        sim.SetAutopilotMode(AutopilotMode::HamiltonianCycle);
+    sim.Reset({}, seed);
+
+    // Games run in parallel, so each planner runs on the thread of its game
+    ea::unique_ptr<MonteCarloPlanner> planner;
+    if (playerType == PlayerType::Planner)
+    {
+        planner = ea::make_unique<MonteCarloPlanner>(gridSize, 0);
+        MonteCarloSettings plannerSettings;
+        plannerSettings.timeBudget_ = timeBudget;
+        planner->SetSettings(plannerSettings);
+    }
+
+    GameResult result;
+    while (!sim.IsGameOver() && result.numTicks_ < maxTicks)
+    {
+        const auto decisionTime = Clock::now();
+        const UserAction action = planner ? planner->PlanAction(sim) : sim.EstimateCachedBestAction();
+        const double elapsed = GetElapsed(decisionTime);
+        result.decisionTime_ += elapsed;
+        result.maxDecisionTime_ = ea::max(result.maxDecisionTime_, elapsed);
+
+        sim.SetNextAction(action);
+        sim.Tick();
+        ++result.numTicks_;
+    }
+
+    // Snake may die after eating the last target, which still fills the board
+    const auto size = static_cast<unsigned>(gridSize);
+    const bool boardFilled = sim.GetSnakeLength() + 1 >= size * size * size * size;
+    result.score_ = sim.GetSnakeLength();
+    result.outcome_ = !sim.IsGameOver() ? GameOutcome::Stopped
+        : sim.HasDeathAnimation() && !boardFilled ? GameOutcome::Died
+        : GameOutcome::Won;
+    return result;
+}
+
+/// Return value at given fraction of sorted values.
+unsigned GetPercentile(const ea::vector<unsigned>& sortedValues, double fraction)
+{
+    const auto index = static_cast<unsigned>(fraction * (sortedValues.size() - 1) + 0.5);
+    return sortedValues[index];
+}
+
+}
+
+/// Usage: Tournament [pathfinder|perfect|planner] [numGames] [gridSize] [numThreads] [maxTicks] [plannerBudgetMs] [firstSeed] [wrapAround]
+int main(int argc, char* argv[])
+{
+    PlayerType playerType = PlayerType::Planner;
+    if (argc > 1 && !ParsePlayerType(argv[1], playerType))
+    {
+        fprintf(stderr, "Unknown player '%s', expected pathfinder, perfect or planner\n", argv[1]);
+        return 1;
+    }
+
+    const unsigned hardwareThreads = ea::max(1u, std::thread::hardware_concurrency());
+    const unsigned numGames = ea::max(1u, ParseArgument(argc, argv, 2, 1000));
+    // Games on the board of the game are long, smaller boards are played to the end quickly
+    const int gridSize = static_cast<int>(ea::max(4u, ParseArgument(argc, argv, 3, 11)));
+    const unsigned numThreads = ea::max(1u, ParseArgument(argc, argv, 4, hardwareThreads));
+    const unsigned maxTicks = ParseArgument(argc, argv, 5, 20000);
+    const float timeBudget = ParseArgument(argc, argv, 6, 2) * 0.001f;
+    const unsigned firstSeed = ParseArgument(argc, argv, 7, 0);
+    // Board without walls, coordinates wrap around board edges
+    const bool wrapAround = ParseArgument(argc, argv, 8, 0) != 0;
+
+    WorkerPool pool(numThreads - 1);
+    printf("Playing %u games of %s on %s of size %d on %u threads\n",
+        numGames, argc > 1 ? argv[1] : "planner", wrapAround ? "torus" : "board", gridSize, pool.GetNumThreads());
+
+    // Each game has its own seed, so results do not depend on the number of threads
+    ea::vector<GameResult> results(numGames);
+    const auto startTime = Clock::now();
+    pool.ParallelFor(numGames, 1, [&](unsigned begin, unsigned end)
+    {
+        for (unsigned i = begin; i < end; ++i)
+            results[i] = PlayGame(playerType, gridSize, wrapAround, firstSeed + i, maxTicks, timeBudget);
+    });
+    const double elapsed = GetElapsed(startTime);
+
+    // Collect statistics
+    ea::vector<unsigned> scores;
+    unsigned long long totalTicks = 0;
+    double totalScore = 0.0;
+    double totalDecisionTime = 0.0;
+    double maxDecisionTime = 0.0;
+    unsigned numOutcomes[3]{};
+    unsigned long long checksum = 14695981039346656037ull;
+    for (const GameResult& result : results)
+    {
+        scores.push_back(result.score_);
+        totalTicks += result.numTicks_;
+        totalScore += result.score_;
+        totalDecisionTime += result.decisionTime_;
+        maxDecisionTime = ea::max(maxDecisionTime, result.maxDecisionTime_);
+        ++numOutcomes[static_cast<unsigned>(result.outcome_)];
+
+        checksum ^= result.score_;
+        checksum *= 1099511628211ull;
+        checksum ^= result.numTicks_;
+        checksum *= 1099511628211ull;
+    }
+
+    const double meanScore = totalScore / numGames;
+    double scoreVariance = 0.0;
+    for (unsigned score : scores)
+        scoreVariance += (score - meanScore) * (score - meanScore);
+    scoreVariance /= numGames;
+    ea::sort(scores.begin(), scores.end());
+
+    printf("Score: mean %.1f, stddev %.1f, min %u, p10 %u, p25 %u, median %u, p75 %u, p90 %u, max %u\n",
+        meanScore, std::sqrt(scoreVariance), scores.front(), GetPercentile(scores, 0.1), GetPercentile(scores, 0.25),
+        GetPercentile(scores, 0.5), GetPercentile(scores, 0.75), GetPercentile(scores, 0.9), scores.back());
+    printf("Outcome: won %u, died %u, stopped %u\n", numOutcomes[0], numOutcomes[1], numOutcomes[2]);
+    printf("%llu ticks in %.2f s: %.0f ticks per second, %.1f games per second\n",
+        totalTicks, elapsed, totalTicks / elapsed, numGames / elapsed);
+    printf("Decision time per tick: mean %.1f us, max %.1f us\n",
+        totalDecisionTime * 1000000.0 / ea::max(1ull, totalTicks), maxDecisionTime * 1000000.0);
+    // Planner depends on timing, other players must keep the checksum unless AI is changed
+    printf("Checksum %016llx\n", checksum);
+    return 0;
+}